@@ -0,0 +1,28 @@
+#!/usr/bin/env bash
+
+# Render the caustics scene and the Cornell box with exact and
+# (1 + epsilon)-approximate nearest photon searches in the global map, and
+# report the time of the render pass and the image error against exact.
+# Usage: [EXTRA="<setting> <value> ..."] ./bench_knn.sh [epsilons...]
+set -e
+EPSILONS=${@:-0.1 0.25 0.5 1}
+
+# a build directory of its own, as the tracked build/ is configured for
+# another checkout
+mkdir -p build_bench
+cd build_bench
+cmake .. > /dev/null
+make -j PA1 imgdiff
+cd ..
+
+mkdir -p output
+for SCENE in testcases/caustics.txt testcases/cornell.txt; do
+    NAME=$(basename $SCENE .txt)
+    RESULT=$(bin/PA1 $SCENE output/bench_knn_$NAME.bmp $EXTRA | grep "^render:")
+    echo "$NAME, exact: $RESULT"
+    for E in $EPSILONS; do
+        RESULT=$(bin/PA1 $SCENE output/bench_knn_$NAME\_$E.bmp knnEpsilon $E $EXTRA | grep "^render:")
+        ERROR=$(bin/imgdiff output/bench_knn_$NAME.bmp output/bench_knn_$NAME\_$E.bmp | grep -E "^(RMSE|PSNR)" | tr '\n' ' ')
+        echo "$NAME, knnEpsilon $E: $RESULT, $ERROR"
+    done
+done
@@ -0,0 +1,24 @@
+#!/usr/bin/env bash
+
+# Render one scene with the double (PA1) and float (PA1_float) builds,
+# then report wall time of each and the image error of float against double.
+# Usage: ./bench_precision.sh [scene file]
+set -e
+SCENE=${1:-testcases/caustics.txt}
+
+# a build directory of its own, as the tracked build/ is configured for
+# another checkout
+mkdir -p build_bench
+cd build_bench
+cmake .. > /dev/null
+make -j PA1 PA1_float imgdiff
+cd ..
+
+mkdir -p output
+for BIN in PA1 PA1_float; do
+    START=$(date +%s%N)
+    bin/$BIN $SCENE output/bench_$BIN.bmp > /dev/null
+    END=$(date +%s%N)
+    echo "$BIN: $(( (END - START) / 1000000 )) ms"
+done
+bin/imgdiff output/bench_PA1.bmp output/bench_PA1_float.bmp
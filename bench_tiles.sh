@@ -0,0 +1,35 @@
+#!/usr/bin/env bash
+
+# Render one scene with several tile layouts and thread counts and report the
+# time of the render pass (photon tracing is not affected by the layout).
+# tileSize 0 is the old one-column-per-task loop. If perf is installed, cache
+# misses of the whole run are reported as well.
+# Usage: [EXTRA="<setting> <value> ..."] ./bench_tiles.sh [scene file] [thread counts...]
+set -e
+SCENE=${1:-testcases/caustics.txt}
+shift $(( $# > 0 ))
+THREADS=${@:-1 $(nproc)}
+
+# a build directory of its own, as the tracked build/ is configured for
+# another checkout
+mkdir -p build_bench
+cd build_bench
+cmake .. > /dev/null
+make -j PA1
+cd ..
+
+mkdir -p output
+for T in $THREADS; do
+    for CONFIG in "tileSize 0" "tileSize 8 tileOrder morton" "tileSize 16 tileOrder morton" \
+                  "tileSize 32 tileOrder morton" "tileSize 16 tileOrder spiral" "tileSize 16 tileOrder scanline"; do
+        if command -v perf > /dev/null; then
+            RESULT=$(OMP_NUM_THREADS=$T perf stat -x, -e cache-misses -o output/bench_tiles.perf \
+                     bin/PA1 $SCENE output/bench_tiles.bmp $CONFIG $EXTRA | grep "^render:")
+            MISSES=$(cut -d, -f1 output/bench_tiles.perf | grep -E '^[0-9]+$' || true)
+            echo "threads $T, $CONFIG: $RESULT, cache misses $MISSES"
+        else
+            RESULT=$(OMP_NUM_THREADS=$T bin/PA1 $SCENE output/bench_tiles.bmp $CONFIG $EXTRA | grep "^render:")
+            echo "threads $T, $CONFIG: $RESULT"
+        fi
+    done
+done
@@ -2,6 +2,7 @@
 #define MATRIX3F_H
 
 #include <cstdio>
+#include "Real.h"
 
 class Matrix2f;
 class Quat4f;
@@ -13,10 +14,10 @@ class Matrix3f
 public:
 
     // Fill a 3x3 matrix with "fill", default to 0.
-	Matrix3f( double fill = 0.f );
-	Matrix3f( double m00, double m01, double m02,
-		double m10, double m11, double m12,
-		double m20, double m21, double m22 );
+	Matrix3f( Real fill = 0.f );
+	Matrix3f( Real m00, Real m01, Real m02,
+		Real m10, Real m11, Real m12,
+		Real m20, Real m21, Real m22 );
 
 	// setColumns = true ==> sets the columns of the matrix to be [v0 v1 v2]
 	// otherwise, sets the rows
@@ -26,8 +27,8 @@ public:
 	Matrix3f& operator = ( const Matrix3f& rm ); // assignment operator
 	// no destructor necessary
 
-	const double& operator () ( int i, int j ) const;
-	double& operator () ( int i, int j );
+	const Real& operator () ( int i, int j ) const;
+	Real& operator () ( int i, int j );
 
 	Vector3f getRow( int i ) const;
 	void setRow( int i, const Vector3f& v );
@@ -43,28 +44,28 @@ public:
 	// starting with upper left corner at (i0, j0)
 	void setSubmatrix2x2( int i0, int j0, const Matrix2f& m );
 
-	double determinant() const;
-	Matrix3f inverse( bool* pbIsSingular = NULL, double epsilon = 0.f ) const; // TODO: invert in place as well
+	Real determinant() const;
+	Matrix3f inverse( bool* pbIsSingular = NULL, Real epsilon = 0.f ) const; // TODO: invert in place as well
 
 	void transpose();
 	Matrix3f transposed() const;
 
 	// ---- Utility ----
-	operator double* (); // automatic type conversion for GL
+	operator Real* (); // automatic type conversion for GL
 	void print();
 
-	static double determinant3x3( double m00, double m01, double m02,
-		double m10, double m11, double m12,
-		double m20, double m21, double m22 );
+	static Real determinant3x3( Real m00, Real m01, Real m02,
+		Real m10, Real m11, Real m12,
+		Real m20, Real m21, Real m22 );
 
 	static Matrix3f ones();
 	static Matrix3f identity();
-	static Matrix3f rotateX( double radians );
-	static Matrix3f rotateY( double radians );
-	static Matrix3f rotateZ( double radians );
-	static Matrix3f scaling( double sx, double sy, double sz );
-	static Matrix3f uniformScaling( double s );
-	static Matrix3f rotation( const Vector3f& rDirection, double radians );
+	static Matrix3f rotateX( Real radians );
+	static Matrix3f rotateY( Real radians );
+	static Matrix3f rotateZ( Real radians );
+	static Matrix3f scaling( Real sx, Real sy, Real sz );
+	static Matrix3f uniformScaling( Real s );
+	static Matrix3f rotation( const Vector3f& rDirection, Real radians );
 
 	// Returns the rotation matrix represented by a unit quaternion
 	// if q is not normalized, it it normalized first
@@ -72,7 +73,7 @@ public:
 
 private:
 
-	double m_elements[ 9 ];
+	Real m_elements[ 9 ];
 
 };
 
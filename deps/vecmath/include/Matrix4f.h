@@ -2,6 +2,7 @@
 #define MATRIX4F_H
 
 #include <cstdio>
+#include "Real.h"
 
 class Matrix2f;
 class Matrix3f;
@@ -15,11 +16,11 @@ class Matrix4f
 public:
 
     // Fill a 4x4 matrix with "fill".  Default to 0.
-	Matrix4f( double fill = 0.f );
-	Matrix4f( double m00, double m01, double m02, double m03,
-		double m10, double m11, double m12, double m13,
-		double m20, double m21, double m22, double m23,
-		double m30, double m31, double m32, double m33 );
+	Matrix4f( Real fill = 0.f );
+	Matrix4f( Real m00, Real m01, Real m02, Real m03,
+		Real m10, Real m11, Real m12, Real m13,
+		Real m20, Real m21, Real m22, Real m23,
+		Real m30, Real m31, Real m32, Real m33 );
 	
 	// setColumns = true ==> sets the columns of the matrix to be [v0 v1 v2 v3]
 	// otherwise, sets the rows
@@ -27,11 +28,11 @@ public:
 	
 	Matrix4f( const Matrix4f& rm ); // copy constructor
 	Matrix4f& operator = ( const Matrix4f& rm ); // assignment operator
-	Matrix4f& operator/=(double d);
+	Matrix4f& operator/=(Real d);
 	// no destructor necessary
 
-	const double& operator () ( int i, int j ) const;
-	double& operator () ( int i, int j );
+	const Real& operator () ( int i, int j ) const;
+	Real& operator () ( int i, int j );
 
 	Vector4f getRow( int i ) const;
 	void setRow( int i, const Vector4f& v );
@@ -56,34 +57,34 @@ public:
 	// starting with upper left corner at (i0, j0)
 	void setSubmatrix3x3( int i0, int j0, const Matrix3f& m );
 
-	double determinant() const;
-	Matrix4f inverse( bool* pbIsSingular = NULL, double epsilon = 0.f ) const;
+	Real determinant() const;
+	Matrix4f inverse( bool* pbIsSingular = NULL, Real epsilon = 0.f ) const;
 
 	void transpose();
 	Matrix4f transposed() const;
 
 	// ---- Utility ----
-	operator double* (); // automatic type conversion for GL
-	operator const double* () const; // automatic type conversion for GL
+	operator Real* (); // automatic type conversion for GL
+	operator const Real* () const; // automatic type conversion for GL
 	
 	void print();
 
 	static Matrix4f ones();
 	static Matrix4f identity();
-	static Matrix4f translation( double x, double y, double z );
+	static Matrix4f translation( Real x, Real y, Real z );
 	static Matrix4f translation( const Vector3f& rTranslation );
-	static Matrix4f rotateX( double radians );
-	static Matrix4f rotateY( double radians );
-	static Matrix4f rotateZ( double radians );
-	static Matrix4f rotation( const Vector3f& rDirection, double radians );
-	static Matrix4f scaling( double sx, double sy, double sz );
-	static Matrix4f uniformScaling( double s );
+	static Matrix4f rotateX( Real radians );
+	static Matrix4f rotateY( Real radians );
+	static Matrix4f rotateZ( Real radians );
+	static Matrix4f rotation( const Vector3f& rDirection, Real radians );
+	static Matrix4f scaling( Real sx, Real sy, Real sz );
+	static Matrix4f uniformScaling( Real s );
 	static Matrix4f lookAt( const Vector3f& eye, const Vector3f& center, const Vector3f& up );
-	static Matrix4f orthographicProjection( double width, double height, double zNear, double zFar, bool directX );
-	static Matrix4f orthographicProjection( double left, double right, double bottom, double top, double zNear, double zFar, bool directX );
-	static Matrix4f perspectiveProjection( double fLeft, double fRight, double fBottom, double fTop, double fZNear, double fZFar, bool directX );
-	static Matrix4f perspectiveProjection( double fovYRadians, double aspect, double zNear, double zFar, bool directX );
-	static Matrix4f infinitePerspectiveProjection( double fLeft, double fRight, double fBottom, double fTop, double fZNear, bool directX );
+	static Matrix4f orthographicProjection( Real width, Real height, Real zNear, Real zFar, bool directX );
+	static Matrix4f orthographicProjection( Real left, Real right, Real bottom, Real top, Real zNear, Real zFar, bool directX );
+	static Matrix4f perspectiveProjection( Real fLeft, Real fRight, Real fBottom, Real fTop, Real fZNear, Real fZFar, bool directX );
+	static Matrix4f perspectiveProjection( Real fovYRadians, Real aspect, Real zNear, Real zFar, bool directX );
+	static Matrix4f infinitePerspectiveProjection( Real fLeft, Real fRight, Real fBottom, Real fTop, Real fZNear, bool directX );
 
 	// Returns the rotation matrix represented by a quaternion
 	// uses a normalized version of q
@@ -91,11 +92,11 @@ public:
 
 	// returns an orthogonal matrix that's a uniformly distributed rotation
 	// given u[i] is a uniformly distributed random number in [0,1]
-	static Matrix4f randomRotation( double u0, double u1, double u2 );
+	static Matrix4f randomRotation( Real u0, Real u1, Real u2 );
 
 private:
 
-	double m_elements[ 16 ];
+	Real m_elements[ 16 ];
 
 };
 
@@ -0,0 +1,12 @@
+#ifndef REAL_H
+#define REAL_H
+
+// Scalar type used by vecmath and everything built on top of it.
+// Define VECMATH_USE_FLOAT to build the single-precision variant.
+#ifdef VECMATH_USE_FLOAT
+typedef float Real;
+#else
+typedef double Real;
+#endif
+
+#endif // REAL_H
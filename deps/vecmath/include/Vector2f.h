@@ -2,6 +2,7 @@
 #define VECTOR_2F_H
 
 #include <cmath>
+#include "Real.h"
 
 class Vector3f;
 
@@ -13,8 +14,8 @@ public:
 	static const Vector2f UP;
 	static const Vector2f RIGHT;
 
-    Vector2f( double f = 0.f );
-    Vector2f( double x, double y );
+    Vector2f( Real f = 0.f );
+    Vector2f( Real x, Real y );
 
 	// copy constructors
     Vector2f( const Vector2f& rv );
@@ -25,14 +26,14 @@ public:
 	// no destructor necessary
 
 	// returns the ith element
-    const double& operator [] ( int i ) const;
-	double& operator [] ( int i );
+    const Real& operator [] ( int i ) const;
+	Real& operator [] ( int i );
 
-    double& x();
-	double& y();
+    Real& x();
+	Real& y();
 
-	double x() const;
-	double y() const;
+	Real x() const;
+	Real y() const;
 
     Vector2f xy() const;
 	Vector2f yx() const;
@@ -42,32 +43,32 @@ public:
 	// returns ( -y, x )
     Vector2f normal() const;
 
-    double abs() const;
-    double absSquared() const;
+    Real abs() const;
+    Real absSquared() const;
     void normalize();
     Vector2f normalized() const;
 
     void negate();
 
 	// ---- Utility ----
-    operator const double* () const; // automatic type conversion for OpenGL 
-    operator double* (); // automatic type conversion for OpenGL 
+    operator const Real* () const; // automatic type conversion for OpenGL 
+    operator Real* (); // automatic type conversion for OpenGL 
 	void print() const;
 
 	Vector2f& operator += ( const Vector2f& v );
 	Vector2f& operator -= ( const Vector2f& v );
-	Vector2f& operator *= ( double f );
+	Vector2f& operator *= ( Real f );
 
-    static double dot( const Vector2f& v0, const Vector2f& v1 );
+    static Real dot( const Vector2f& v0, const Vector2f& v1 );
 
 	static Vector3f cross( const Vector2f& v0, const Vector2f& v1 );
 
 	// returns v0 * ( 1 - alpha ) * v1 * alpha
-	static Vector2f lerp( const Vector2f& v0, const Vector2f& v1, double alpha );
+	static Vector2f lerp( const Vector2f& v0, const Vector2f& v1, Real alpha );
 
 private:
 
-	double m_elements[2];
+	Real m_elements[2];
 
 };
 
@@ -81,9 +82,9 @@ Vector2f operator / ( const Vector2f& v0, const Vector2f& v1 );
 Vector2f operator - ( const Vector2f& v );
 
 // multiply and divide by scalar
-Vector2f operator * ( double f, const Vector2f& v );
-Vector2f operator * ( const Vector2f& v, double f );
-Vector2f operator / ( const Vector2f& v, double f );
+Vector2f operator * ( Real f, const Vector2f& v );
+Vector2f operator * ( const Vector2f& v, Real f );
+Vector2f operator / ( const Vector2f& v, Real f );
 
 bool operator == ( const Vector2f& v0, const Vector2f& v1 );
 bool operator != ( const Vector2f& v0, const Vector2f& v1 );
@@ -2,6 +2,7 @@
 #define VECTOR_3F_H
 
 #include<sstream>
+#include "Real.h"
 
 class Vector2f;
 
@@ -14,11 +15,11 @@ public:
 	static const Vector3f RIGHT;
 	static const Vector3f FORWARD;
 
-    Vector3f( double f = 0.f );
-    Vector3f( double x, double y, double z );
+    Vector3f( Real f = 0.f );
+    Vector3f( Real x, Real y, Real z );
 
-	Vector3f( const Vector2f& xy, double z );
-	Vector3f( double x, const Vector2f& yz );
+	Vector3f( const Vector2f& xy, Real z );
+	Vector3f( Real x, const Vector2f& yz );
 
 	// copy constructors
     Vector3f( const Vector3f& rv );
@@ -29,16 +30,16 @@ public:
 	// no destructor necessary
 
 	// returns the ith element
-    const double& operator [] ( int i ) const;
-    double& operator [] ( int i );
+    const Real& operator [] ( int i ) const;
+    Real& operator [] ( int i );
 
-    double& x();
-	double& y();
-	double& z();
+    Real& x();
+	Real& y();
+	Real& z();
 
-	double x() const;
-	double y() const;
-	double z() const;
+	Real x() const;
+	Real y() const;
+	Real z() const;
 
 	Vector2f xy() const;
 	Vector2f xz() const;
@@ -48,8 +49,8 @@ public:
 	Vector3f yzx() const;
 	Vector3f zxy() const;
 
-	double length() const;
-    double squaredLength() const;
+	Real length() const;
+    Real squaredLength() const;
 
 	void normalize();
 	Vector3f normalized() const;
@@ -59,32 +60,32 @@ public:
 	void negate();
 
 	// ---- Utility ----
-    operator const double* () const; // automatic type conversion for OpenGL
-    operator double* (); // automatic type conversion for OpenGL 
+    operator const Real* () const; // automatic type conversion for OpenGL
+    operator Real* (); // automatic type conversion for OpenGL 
 	void print() const;	
 
 	Vector3f& operator += ( const Vector3f& v );
 	Vector3f& operator -= ( const Vector3f& v );
-    Vector3f& operator *= ( double f );
+    Vector3f& operator *= ( Real f );
 
-    static double dot( const Vector3f& v0, const Vector3f& v1 );
+    static Real dot( const Vector3f& v0, const Vector3f& v1 );
 	static Vector3f cross( const Vector3f& v0, const Vector3f& v1 );
     
     // computes the linear interpolation between v0 and v1 by alpha \in [0,1]
 	// returns v0 * ( 1 - alpha ) * v1 * alpha
-	static Vector3f lerp( const Vector3f& v0, const Vector3f& v1, double alpha );
+	static Vector3f lerp( const Vector3f& v0, const Vector3f& v1, Real alpha );
 
 	// computes the cubic catmull-rom interpolation between p0, p1, p2, p3
     // by t \in [0,1].  Guarantees that at t = 0, the result is p0 and
     // at p1, the result is p2.
-	static Vector3f cubicInterpolate( const Vector3f& p0, const Vector3f& p1, const Vector3f& p2, const Vector3f& p3, double t );
+	static Vector3f cubicInterpolate( const Vector3f& p0, const Vector3f& p1, const Vector3f& p2, const Vector3f& p3, Real t );
 
 	void Input( std::stringstream& fin ) {	fin >> m_elements[0] >> m_elements[1] >> m_elements[2];}
-	double avg() const {return (m_elements[0] + m_elements[1] + m_elements[2])/3.0; }
+	Real avg() const {return (m_elements[0] + m_elements[1] + m_elements[2])/3.0; }
 
 private:
 
-	double m_elements[ 3 ];
+	Real m_elements[ 3 ];
 
 };
 
@@ -98,9 +99,9 @@ Vector3f operator / ( const Vector3f& v0, const Vector3f& v1 );
 Vector3f operator - ( const Vector3f& v );
 
 // multiply and divide by scalar
-Vector3f operator * ( double f, const Vector3f& v );
-Vector3f operator * ( const Vector3f& v, double f );
-Vector3f operator / ( const Vector3f& v, double f );
+Vector3f operator * ( Real f, const Vector3f& v );
+Vector3f operator * ( const Vector3f& v, Real f );
+Vector3f operator / ( const Vector3f& v, Real f );
 
 bool operator == ( const Vector3f& v0, const Vector3f& v1 );
 bool operator != ( const Vector3f& v0, const Vector3f& v1 );
@@ -1,6 +1,8 @@
 #ifndef VECTOR_4F_H
 #define VECTOR_4F_H
 
+#include "Real.h"
+
 class Vector2f;
 class Vector3f;
 
@@ -8,17 +10,17 @@ class Vector4f
 {
 public:
 
-	Vector4f( double f = 0.f );
-	Vector4f( double fx, double fy, double fz, double fw );
-	Vector4f( double buffer[ 4 ] );
+	Vector4f( Real f = 0.f );
+	Vector4f( Real fx, Real fy, Real fz, Real fw );
+	Vector4f( Real buffer[ 4 ] );
 
-	Vector4f( const Vector2f& xy, double z, double w );
-	Vector4f( double x, const Vector2f& yz, double w );
-	Vector4f( double x, double y, const Vector2f& zw );
+	Vector4f( const Vector2f& xy, Real z, Real w );
+	Vector4f( Real x, const Vector2f& yz, Real w );
+	Vector4f( Real x, Real y, const Vector2f& zw );
 	Vector4f( const Vector2f& xy, const Vector2f& zw );
 
-	Vector4f( const Vector3f& xyz, double w );
-	Vector4f( double x, const Vector3f& yzw );
+	Vector4f( const Vector3f& xyz, Real w );
+	Vector4f( Real x, const Vector3f& yzw );
 
 	// copy constructors
 	Vector4f( const Vector4f& rv );
@@ -29,18 +31,18 @@ public:
 	// no destructor necessary
 
 	// returns the ith element
-	const double& operator [] ( int i ) const;
-	double& operator [] ( int i );
+	const Real& operator [] ( int i ) const;
+	Real& operator [] ( int i );
 
-	double& x();
-	double& y();
-	double& z();
-	double& w();
+	Real& x();
+	Real& y();
+	Real& z();
+	Real& w();
 
-	double x() const;
-	double y() const;
-	double z() const;
-	double w() const;
+	Real x() const;
+	Real y() const;
+	Real z() const;
+	Real w() const;
 
 	Vector2f xy() const;
 	Vector2f yz() const;
@@ -57,8 +59,8 @@ public:
 	Vector3f zwy() const;
 	Vector3f wxz() const;
 
-	double abs() const;
-	double absSquared() const;
+	Real abs() const;
+	Real absSquared() const;
 	void normalize();
 	Vector4f normalized() const;
 
@@ -69,16 +71,16 @@ public:
 	void negate();
 
 	// ---- Utility ----
-	operator const double* () const; // automatic type conversion for OpenGL
-	operator double* (); // automatic type conversion for OpenG
+	operator const Real* () const; // automatic type conversion for OpenGL
+	operator Real* (); // automatic type conversion for OpenG
 	void print() const; 
 
-	static double dot( const Vector4f& v0, const Vector4f& v1 );
-	static Vector4f lerp( const Vector4f& v0, const Vector4f& v1, double alpha );
+	static Real dot( const Vector4f& v0, const Vector4f& v1 );
+	static Vector4f lerp( const Vector4f& v0, const Vector4f& v1, Real alpha );
 
 private:
 
-	double m_elements[ 4 ];
+	Real m_elements[ 4 ];
 
 };
 
@@ -92,9 +94,9 @@ Vector4f operator / ( const Vector4f& v0, const Vector4f& v1 );
 Vector4f operator - ( const Vector4f& v );
 
 // multiply and divide by scalar
-Vector4f operator * ( double f, const Vector4f& v );
-Vector4f operator * ( const Vector4f& v, double f );
-Vector4f operator / ( const Vector4f& v, double f );
+Vector4f operator * ( Real f, const Vector4f& v );
+Vector4f operator * ( const Vector4f& v, Real f );
+Vector4f operator / ( const Vector4f& v, Real f );
 
 bool operator == ( const Vector4f& v0, const Vector4f& v1 );
 bool operator != ( const Vector4f& v0, const Vector4f& v1 );
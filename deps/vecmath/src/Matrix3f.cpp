@@ -9,7 +9,7 @@
 #include "Quat4f.h"
 #include "Vector3f.h"
 
-Matrix3f::Matrix3f( double fill )
+Matrix3f::Matrix3f( Real fill )
 {
 	for( int i = 0; i < 9; ++i )
 	{
@@ -17,9 +17,9 @@ Matrix3f::Matrix3f( double fill )
 	}
 }
 
-Matrix3f::Matrix3f( double m00, double m01, double m02,
-				   double m10, double m11, double m12,
-				   double m20, double m21, double m22 )
+Matrix3f::Matrix3f( Real m00, Real m01, Real m02,
+				   Real m10, Real m11, Real m12,
+				   Real m20, Real m21, Real m22 )
 {
 	m_elements[ 0 ] = m00;
 	m_elements[ 1 ] = m10;
@@ -52,24 +52,24 @@ Matrix3f::Matrix3f( const Vector3f& v0, const Vector3f& v1, const Vector3f& v2,
 
 Matrix3f::Matrix3f( const Matrix3f& rm )
 {
-	memcpy( m_elements, rm.m_elements, 9 * sizeof( double ) );
+	memcpy( m_elements, rm.m_elements, 9 * sizeof( Real ) );
 }
 
 Matrix3f& Matrix3f::operator = ( const Matrix3f& rm )
 {
 	if( this != &rm )
 	{
-		memcpy( m_elements, rm.m_elements, 9 * sizeof( double ) );
+		memcpy( m_elements, rm.m_elements, 9 * sizeof( Real ) );
 	}
 	return *this;
 }
 
-const double& Matrix3f::operator () ( int i, int j ) const
+const Real& Matrix3f::operator () ( int i, int j ) const
 {
 	return m_elements[ j * 3 + i ];
 }
 
-double& Matrix3f::operator () ( int i, int j )
+Real& Matrix3f::operator () ( int i, int j )
 {
 	return m_elements[ j * 3 + i ];
 }
@@ -138,7 +138,7 @@ void Matrix3f::setSubmatrix2x2( int i0, int j0, const Matrix2f& m )
 	}
 }
 
-double Matrix3f::determinant() const
+Real Matrix3f::determinant() const
 {
 	return Matrix3f::determinant3x3
 	(
@@ -148,33 +148,33 @@ double Matrix3f::determinant() const
 	);
 }
 
-Matrix3f Matrix3f::inverse( bool* pbIsSingular, double epsilon ) const
+Matrix3f Matrix3f::inverse( bool* pbIsSingular, Real epsilon ) const
 {
-	double m00 = m_elements[ 0 ];
-	double m10 = m_elements[ 1 ];
-	double m20 = m_elements[ 2 ];
+	Real m00 = m_elements[ 0 ];
+	Real m10 = m_elements[ 1 ];
+	Real m20 = m_elements[ 2 ];
 
-	double m01 = m_elements[ 3 ];
-	double m11 = m_elements[ 4 ];
-	double m21 = m_elements[ 5 ];
+	Real m01 = m_elements[ 3 ];
+	Real m11 = m_elements[ 4 ];
+	Real m21 = m_elements[ 5 ];
 
-	double m02 = m_elements[ 6 ];
-	double m12 = m_elements[ 7 ];
-	double m22 = m_elements[ 8 ];
+	Real m02 = m_elements[ 6 ];
+	Real m12 = m_elements[ 7 ];
+	Real m22 = m_elements[ 8 ];
 
-	double cofactor00 =  Matrix2f::determinant2x2( m11, m12, m21, m22 );
-	double cofactor01 = -Matrix2f::determinant2x2( m10, m12, m20, m22 );
-	double cofactor02 =  Matrix2f::determinant2x2( m10, m11, m20, m21 );
+	Real cofactor00 =  Matrix2f::determinant2x2( m11, m12, m21, m22 );
+	Real cofactor01 = -Matrix2f::determinant2x2( m10, m12, m20, m22 );
+	Real cofactor02 =  Matrix2f::determinant2x2( m10, m11, m20, m21 );
 
-	double cofactor10 = -Matrix2f::determinant2x2( m01, m02, m21, m22 );
-	double cofactor11 =  Matrix2f::determinant2x2( m00, m02, m20, m22 );
-	double cofactor12 = -Matrix2f::determinant2x2( m00, m01, m20, m21 );
+	Real cofactor10 = -Matrix2f::determinant2x2( m01, m02, m21, m22 );
+	Real cofactor11 =  Matrix2f::determinant2x2( m00, m02, m20, m22 );
+	Real cofactor12 = -Matrix2f::determinant2x2( m00, m01, m20, m21 );
 
-	double cofactor20 =  Matrix2f::determinant2x2( m01, m02, m11, m12 );
-	double cofactor21 = -Matrix2f::determinant2x2( m00, m02, m10, m12 );
-	double cofactor22 =  Matrix2f::determinant2x2( m00, m01, m10, m11 );
+	Real cofactor20 =  Matrix2f::determinant2x2( m01, m02, m11, m12 );
+	Real cofactor21 = -Matrix2f::determinant2x2( m00, m02, m10, m12 );
+	Real cofactor22 =  Matrix2f::determinant2x2( m00, m01, m10, m11 );
 
-	double determinant = m00 * cofactor00 + m01 * cofactor01 + m02 * cofactor02;
+	Real determinant = m00 * cofactor00 + m01 * cofactor01 + m02 * cofactor02;
 	
 	bool isSingular = ( fabs( determinant ) < epsilon );
 	if( isSingular )
@@ -192,7 +192,7 @@ Matrix3f Matrix3f::inverse( bool* pbIsSingular, double epsilon ) const
 			*pbIsSingular = false;
 		}
 
-		double reciprocalDeterminant = 1.0f / determinant;
+		Real reciprocalDeterminant = 1.0f / determinant;
 
 		return Matrix3f
 		(
@@ -205,7 +205,7 @@ Matrix3f Matrix3f::inverse( bool* pbIsSingular, double epsilon ) const
 
 void Matrix3f::transpose()
 {
-	double temp;
+	Real temp;
 
 	for( int i = 0; i < 2; ++i )
 	{
@@ -232,7 +232,7 @@ Matrix3f Matrix3f::transposed() const
 	return out;
 }
 
-Matrix3f::operator double* ()
+Matrix3f::operator Real* ()
 {
 	return m_elements;
 }
@@ -246,9 +246,9 @@ void Matrix3f::print()
 }
 
 // static
-double Matrix3f::determinant3x3( double m00, double m01, double m02,
-							   double m10, double m11, double m12,
-							   double m20, double m21, double m22 )
+Real Matrix3f::determinant3x3( Real m00, Real m01, Real m02,
+							   Real m10, Real m11, Real m12,
+							   Real m20, Real m21, Real m22 )
 {
 	return
 		(
@@ -284,10 +284,10 @@ Matrix3f Matrix3f::identity()
 
 
 // static
-Matrix3f Matrix3f::rotateX( double radians )
+Matrix3f Matrix3f::rotateX( Real radians )
 {
-	double c = cos( radians );
-	double s = sin( radians );
+	Real c = cos( radians );
+	Real s = sin( radians );
 
 	return Matrix3f
 	(
@@ -298,10 +298,10 @@ Matrix3f Matrix3f::rotateX( double radians )
 }
 
 // static
-Matrix3f Matrix3f::rotateY( double radians )
+Matrix3f Matrix3f::rotateY( Real radians )
 {
-	double c = cos( radians );
-	double s = sin( radians );
+	Real c = cos( radians );
+	Real s = sin( radians );
 
 	return Matrix3f
 	(
@@ -312,10 +312,10 @@ Matrix3f Matrix3f::rotateY( double radians )
 }
 
 // static
-Matrix3f Matrix3f::rotateZ( double radians )
+Matrix3f Matrix3f::rotateZ( Real radians )
 {
-	double c = cos( radians );
-	double s = sin( radians );
+	Real c = cos( radians );
+	Real s = sin( radians );
 
 	return Matrix3f
 	(
@@ -326,7 +326,7 @@ Matrix3f Matrix3f::rotateZ( double radians )
 }
 
 // static
-Matrix3f Matrix3f::scaling( double sx, double sy, double sz )
+Matrix3f Matrix3f::scaling( Real sx, Real sy, Real sz )
 {
 	return Matrix3f
 	(
@@ -337,7 +337,7 @@ Matrix3f Matrix3f::scaling( double sx, double sy, double sz )
 }
 
 // static
-Matrix3f Matrix3f::uniformScaling( double s )
+Matrix3f Matrix3f::uniformScaling( Real s )
 {
 	return Matrix3f
 	(
@@ -348,16 +348,16 @@ Matrix3f Matrix3f::uniformScaling( double s )
 }
 
 // static
-Matrix3f Matrix3f::rotation( const Vector3f& rDirection, double radians )
+Matrix3f Matrix3f::rotation( const Vector3f& rDirection, Real radians )
 {
 	Vector3f normalizedDirection = rDirection.normalized();
 	
-	double cosTheta = cos( radians );
-	double sinTheta = sin( radians );
+	Real cosTheta = cos( radians );
+	Real sinTheta = sin( radians );
 
-	double x = normalizedDirection.x();
-	double y = normalizedDirection.y();
-	double z = normalizedDirection.z();
+	Real x = normalizedDirection.x();
+	Real y = normalizedDirection.y();
+	Real z = normalizedDirection.z();
 
 	return Matrix3f
 		(
@@ -372,18 +372,18 @@ Matrix3f Matrix3f::rotation( const Quat4f& rq )
 {
 	Quat4f q = rq.normalized();
 
-	double xx = q.x() * q.x();
-	double yy = q.y() * q.y();
-	double zz = q.z() * q.z();
+	Real xx = q.x() * q.x();
+	Real yy = q.y() * q.y();
+	Real zz = q.z() * q.z();
 
-	double xy = q.x() * q.y();
-	double zw = q.z() * q.w();
+	Real xy = q.x() * q.y();
+	Real zw = q.z() * q.w();
 
-	double xz = q.x() * q.z();
-	double yw = q.y() * q.w();
+	Real xz = q.x() * q.z();
+	Real yw = q.y() * q.w();
 
-	double yz = q.y() * q.z();
-	double xw = q.x() * q.w();
+	Real yz = q.y() * q.z();
+	Real xw = q.x() * q.w();
 
 	return Matrix3f
 		(
@@ -11,7 +11,7 @@
 #include "Vector3f.h"
 #include "Vector4f.h"
 
-Matrix4f::Matrix4f( double fill )
+Matrix4f::Matrix4f( Real fill )
 {
 	for( int i = 0; i < 16; ++i )
 	{
@@ -19,10 +19,10 @@ Matrix4f::Matrix4f( double fill )
 	}
 }
 
-Matrix4f::Matrix4f( double m00, double m01, double m02, double m03,
-				   double m10, double m11, double m12, double m13,
-				   double m20, double m21, double m22, double m23,
-				   double m30, double m31, double m32, double m33 )
+Matrix4f::Matrix4f( Real m00, Real m01, Real m02, Real m03,
+				   Real m10, Real m11, Real m12, Real m13,
+				   Real m20, Real m21, Real m22, Real m23,
+				   Real m30, Real m31, Real m32, Real m33 )
 {
 	m_elements[ 0 ] = m00;
 	m_elements[ 1 ] = m10;
@@ -45,7 +45,7 @@ Matrix4f::Matrix4f( double m00, double m01, double m02, double m03,
 	m_elements[ 15 ] = m33;
 }
 
-Matrix4f& Matrix4f::operator/=(double d)
+Matrix4f& Matrix4f::operator/=(Real d)
 {
 	for(int ii=0;ii<16;ii++){
 		m_elements[ii]/=d;
@@ -73,24 +73,24 @@ Matrix4f::Matrix4f( const Vector4f& v0, const Vector4f& v1, const Vector4f& v2,
 
 Matrix4f::Matrix4f( const Matrix4f& rm )
 {
-	memcpy( m_elements, rm.m_elements, 16 * sizeof( double ) );
+	memcpy( m_elements, rm.m_elements, 16 * sizeof( Real ) );
 }
 
 Matrix4f& Matrix4f::operator = ( const Matrix4f& rm )
 {
 	if( this != &rm )
 	{
-		memcpy( m_elements, rm.m_elements, 16 * sizeof( double ) );
+		memcpy( m_elements, rm.m_elements, 16 * sizeof( Real ) );
 	}
 	return *this;
 }
 
-const double& Matrix4f::operator () ( int i, int j ) const
+const Real& Matrix4f::operator () ( int i, int j ) const
 {
 	return m_elements[ j * 4 + i ];
 }
 
-double& Matrix4f::operator () ( int i, int j )
+Real& Matrix4f::operator () ( int i, int j )
 {
 	return m_elements[ j * 4 + i ];
 }
@@ -189,79 +189,79 @@ void Matrix4f::setSubmatrix3x3( int i0, int j0, const Matrix3f& m )
 	}
 }
 
-double Matrix4f::determinant() const
+Real Matrix4f::determinant() const
 {
-	double m00 = m_elements[ 0 ];
-	double m10 = m_elements[ 1 ];
-	double m20 = m_elements[ 2 ];
-	double m30 = m_elements[ 3 ];
+	Real m00 = m_elements[ 0 ];
+	Real m10 = m_elements[ 1 ];
+	Real m20 = m_elements[ 2 ];
+	Real m30 = m_elements[ 3 ];
 
-	double m01 = m_elements[ 4 ];
-	double m11 = m_elements[ 5 ];
-	double m21 = m_elements[ 6 ];
-	double m31 = m_elements[ 7 ];
+	Real m01 = m_elements[ 4 ];
+	Real m11 = m_elements[ 5 ];
+	Real m21 = m_elements[ 6 ];
+	Real m31 = m_elements[ 7 ];
 
-	double m02 = m_elements[ 8 ];
-	double m12 = m_elements[ 9 ];
-	double m22 = m_elements[ 10 ];
-	double m32 = m_elements[ 11 ];
+	Real m02 = m_elements[ 8 ];
+	Real m12 = m_elements[ 9 ];
+	Real m22 = m_elements[ 10 ];
+	Real m32 = m_elements[ 11 ];
 
-	double m03 = m_elements[ 12 ];
-	double m13 = m_elements[ 13 ];
-	double m23 = m_elements[ 14 ];
-	double m33 = m_elements[ 15 ];
+	Real m03 = m_elements[ 12 ];
+	Real m13 = m_elements[ 13 ];
+	Real m23 = m_elements[ 14 ];
+	Real m33 = m_elements[ 15 ];
 
-	double cofactor00 =  Matrix3f::determinant3x3( m11, m12, m13, m21, m22, m23, m31, m32, m33 );
-	double cofactor01 = -Matrix3f::determinant3x3( m12, m13, m10, m22, m23, m20, m32, m33, m30 );
-	double cofactor02 =  Matrix3f::determinant3x3( m13, m10, m11, m23, m20, m21, m33, m30, m31 );
-	double cofactor03 = -Matrix3f::determinant3x3( m10, m11, m12, m20, m21, m22, m30, m31, m32 );
+	Real cofactor00 =  Matrix3f::determinant3x3( m11, m12, m13, m21, m22, m23, m31, m32, m33 );
+	Real cofactor01 = -Matrix3f::determinant3x3( m12, m13, m10, m22, m23, m20, m32, m33, m30 );
+	Real cofactor02 =  Matrix3f::determinant3x3( m13, m10, m11, m23, m20, m21, m33, m30, m31 );
+	Real cofactor03 = -Matrix3f::determinant3x3( m10, m11, m12, m20, m21, m22, m30, m31, m32 );
 
 	return( m00 * cofactor00 + m01 * cofactor01 + m02 * cofactor02 + m03 * cofactor03 );
 }
 
-Matrix4f Matrix4f::inverse( bool* pbIsSingular, double epsilon ) const
+Matrix4f Matrix4f::inverse( bool* pbIsSingular, Real epsilon ) const
 {
-	double m00 = m_elements[ 0 ];
-	double m10 = m_elements[ 1 ];
-	double m20 = m_elements[ 2 ];
-	double m30 = m_elements[ 3 ];
+	Real m00 = m_elements[ 0 ];
+	Real m10 = m_elements[ 1 ];
+	Real m20 = m_elements[ 2 ];
+	Real m30 = m_elements[ 3 ];
 
-	double m01 = m_elements[ 4 ];
-	double m11 = m_elements[ 5 ];
-	double m21 = m_elements[ 6 ];
-	double m31 = m_elements[ 7 ];
+	Real m01 = m_elements[ 4 ];
+	Real m11 = m_elements[ 5 ];
+	Real m21 = m_elements[ 6 ];
+	Real m31 = m_elements[ 7 ];
 
-	double m02 = m_elements[ 8 ];
-	double m12 = m_elements[ 9 ];
-	double m22 = m_elements[ 10 ];
-	double m32 = m_elements[ 11 ];
+	Real m02 = m_elements[ 8 ];
+	Real m12 = m_elements[ 9 ];
+	Real m22 = m_elements[ 10 ];
+	Real m32 = m_elements[ 11 ];
 
-	double m03 = m_elements[ 12 ];
-	double m13 = m_elements[ 13 ];
-	double m23 = m_elements[ 14 ];
-	double m33 = m_elements[ 15 ];
+	Real m03 = m_elements[ 12 ];
+	Real m13 = m_elements[ 13 ];
+	Real m23 = m_elements[ 14 ];
+	Real m33 = m_elements[ 15 ];
 
-    double cofactor00 =  Matrix3f::determinant3x3( m11, m12, m13, m21, m22, m23, m31, m32, m33 );
-    double cofactor01 = -Matrix3f::determinant3x3( m12, m13, m10, m22, m23, m20, m32, m33, m30 );
-    double cofactor02 =  Matrix3f::determinant3x3( m13, m10, m11, m23, m20, m21, m33, m30, m31 );
-    double cofactor03 = -Matrix3f::determinant3x3( m10, m11, m12, m20, m21, m22, m30, m31, m32 );
+    Real cofactor00 =  Matrix3f::determinant3x3( m11, m12, m13, m21, m22, m23, m31, m32, m33 );
+    Real cofactor01 = -Matrix3f::determinant3x3( m12, m13, m10, m22, m23, m20, m32, m33, m30 );
+    Real cofactor02 =  Matrix3f::determinant3x3( m13, m10, m11, m23, m20, m21, m33, m30, m31 );
+    Real cofactor03 = -Matrix3f::determinant3x3( m10, m11, m12, m20, m21, m22, m30, m31, m32 );
     
-    double cofactor10 = -Matrix3f::determinant3x3( m21, m22, m23, m31, m32, m33, m01, m02, m03 );
-    double cofactor11 =  Matrix3f::determinant3x3( m22, m23, m20, m32, m33, m30, m02, m03, m00 );
-    double cofactor12 = -Matrix3f::determinant3x3( m23, m20, m21, m33, m30, m31, m03, m00, m01 );
-    double cofactor13 =  Matrix3f::determinant3x3( m20, m21, m22, m30, m31, m32, m00, m01, m02 );
+    Real cofactor10 = -Matrix3f::determinant3x3( m21, m22, m23, m31, m32, m33, m01, m02, m03 );
+    Real cofactor11 =  Matrix3f::determinant3x3( m22, m23, m20, m32, m33, m30, m02, m03, m00 );
+    Real cofactor12 = -Matrix3f::determinant3x3( m23, m20, m21, m33, m30, m31, m03, m00, m01 );
+    Real cofactor13 =  Matrix3f::determinant3x3( m20, m21, m22, m30, m31, m32, m00, m01, m02 );
     
-    double cofactor20 =  Matrix3f::determinant3x3( m31, m32, m33, m01, m02, m03, m11, m12, m13 );
-    double cofactor21 = -Matrix3f::determinant3x3( m32, m33, m30, m02, m03, m00, m12, m13, m10 );
-    double cofactor22 =  Matrix3f::determinant3x3( m33, m30, m31, m03, m00, m01, m13, m10, m11 );
-    double cofactor23 = -Matrix3f::determinant3x3( m30, m31, m32, m00, m01, m02, m10, m11, m12 );
+    Real cofactor20 =  Matrix3f::determinant3x3( m31, m32, m33, m01, m02, m03, m11, m12, m13 );
+    Real cofactor21 = -Matrix3f::determinant3x3( m32, m33, m30, m02, m03, m00, m12, m13, m10 );
+    Real cofactor22 =  Matrix3f::determinant3x3( m33, m30, m31, m03, m00, m01, m13, m10, m11 );
+    Real cofactor23 = -Matrix3f::determinant3x3( m30, m31, m32, m00, m01, m02, m10, m11, m12 );
     
-    double cofactor30 = -Matrix3f::determinant3x3( m01, m02, m03, m11, m12, m13, m21, m22, m23 );
-    double cofactor31 =  Matrix3f::determinant3x3( m02, m03, m00, m12, m13, m10, m22, m23, m20 );
-    double cofactor32 = -Matrix3f::determinant3x3( m03, m00, m01, m13, m10, m11, m23, m20, m21 );
-    double cofactor33 =  Matrix3f::determinant3x3( m00, m01, m02, m10, m11, m12, m20, m21, m22 );
+    Real cofactor30 = -Matrix3f::determinant3x3( m01, m02, m03, m11, m12, m13, m21, m22, m23 );
+    Real cofactor31 =  Matrix3f::determinant3x3( m02, m03, m00, m12, m13, m10, m22, m23, m20 );
+    Real cofactor32 = -Matrix3f::determinant3x3( m03, m00, m01, m13, m10, m11, m23, m20, m21 );
+    Real cofactor33 =  Matrix3f::determinant3x3( m00, m01, m02, m10, m11, m12, m20, m21, m22 );
 
-	double determinant = m00 * cofactor00 + m01 * cofactor01 + m02 * cofactor02 + m03 * cofactor03;
+	Real determinant = m00 * cofactor00 + m01 * cofactor01 + m02 * cofactor02 + m03 * cofactor03;
 
 	bool isSingular = ( fabs( determinant ) < epsilon );
 	if( isSingular )
@@ -279,7 +279,7 @@ Matrix4f Matrix4f::inverse( bool* pbIsSingular, double epsilon ) const
 			*pbIsSingular = false;
 		}
 
-		double reciprocalDeterminant = 1.0f / determinant;
+		Real reciprocalDeterminant = 1.0f / determinant;
 
 		return Matrix4f
 			(
@@ -293,7 +293,7 @@ Matrix4f Matrix4f::inverse( bool* pbIsSingular, double epsilon ) const
 
 void Matrix4f::transpose()
 {
-	double temp;
+	Real temp;
 
 	for( int i = 0; i < 3; ++i )
 	{
@@ -320,12 +320,12 @@ Matrix4f Matrix4f::transposed() const
 	return out;
 }
 
-Matrix4f::operator double* ()
+Matrix4f::operator Real* ()
 {
 	return m_elements;
 }
 
-Matrix4f::operator const double* ()const
+Matrix4f::operator const Real* ()const
 {
 	return m_elements;
 }
@@ -366,7 +366,7 @@ Matrix4f Matrix4f::identity()
 }
 
 // static
-Matrix4f Matrix4f::translation( double x, double y, double z )
+Matrix4f Matrix4f::translation( Real x, Real y, Real z )
 {
 	return Matrix4f
 	(
@@ -390,10 +390,10 @@ Matrix4f Matrix4f::translation( const Vector3f& rTranslation )
 }
 
 // static
-Matrix4f Matrix4f::rotateX( double radians )
+Matrix4f Matrix4f::rotateX( Real radians )
 {
-	double c = cos( radians );
-	double s = sin( radians );
+	Real c = cos( radians );
+	Real s = sin( radians );
 
 	return Matrix4f
 	(
@@ -405,10 +405,10 @@ Matrix4f Matrix4f::rotateX( double radians )
 }
 
 // static
-Matrix4f Matrix4f::rotateY( double radians )
+Matrix4f Matrix4f::rotateY( Real radians )
 {
-	double c = cos( radians );
-	double s = sin( radians );
+	Real c = cos( radians );
+	Real s = sin( radians );
 
 	return Matrix4f
 	(
@@ -420,10 +420,10 @@ Matrix4f Matrix4f::rotateY( double radians )
 }
 
 // static
-Matrix4f Matrix4f::rotateZ( double radians )
+Matrix4f Matrix4f::rotateZ( Real radians )
 {
-	double c = cos( radians );
-	double s = sin( radians );
+	Real c = cos( radians );
+	Real s = sin( radians );
 
 	return Matrix4f
 	(
@@ -435,16 +435,16 @@ Matrix4f Matrix4f::rotateZ( double radians )
 }
 
 // static
-Matrix4f Matrix4f::rotation( const Vector3f& rDirection, double radians )
+Matrix4f Matrix4f::rotation( const Vector3f& rDirection, Real radians )
 {
 	Vector3f normalizedDirection = rDirection.normalized();
 	
-	double cosTheta = cos( radians );
-	double sinTheta = sin( radians );
+	Real cosTheta = cos( radians );
+	Real sinTheta = sin( radians );
 
-	double x = normalizedDirection.x();
-	double y = normalizedDirection.y();
-	double z = normalizedDirection.z();
+	Real x = normalizedDirection.x();
+	Real y = normalizedDirection.y();
+	Real z = normalizedDirection.z();
 
 	return Matrix4f
 	(
@@ -460,18 +460,18 @@ Matrix4f Matrix4f::rotation( const Quat4f& q )
 {
 	Quat4f qq = q.normalized();
 
-	double xx = qq.x() * qq.x();
-	double yy = qq.y() * qq.y();
-	double zz = qq.z() * qq.z();
+	Real xx = qq.x() * qq.x();
+	Real yy = qq.y() * qq.y();
+	Real zz = qq.z() * qq.z();
 
-	double xy = qq.x() * qq.y();
-	double zw = qq.z() * qq.w();
+	Real xy = qq.x() * qq.y();
+	Real zw = qq.z() * qq.w();
 
-	double xz = qq.x() * qq.z();
-	double yw = qq.y() * qq.w();
+	Real xz = qq.x() * qq.z();
+	Real yw = qq.y() * qq.w();
 
-	double yz = qq.y() * qq.z();
-	double xw = qq.x() * qq.w();
+	Real yz = qq.y() * qq.z();
+	Real xw = qq.x() * qq.w();
 
 	return Matrix4f
 	(
@@ -483,7 +483,7 @@ Matrix4f Matrix4f::rotation( const Quat4f& q )
 }
 
 // static
-Matrix4f Matrix4f::scaling( double sx, double sy, double sz )
+Matrix4f Matrix4f::scaling( Real sx, Real sy, Real sz )
 {
 	return Matrix4f
 	(
@@ -495,7 +495,7 @@ Matrix4f Matrix4f::scaling( double sx, double sy, double sz )
 }
 
 // static
-Matrix4f Matrix4f::uniformScaling( double s )
+Matrix4f Matrix4f::uniformScaling( Real s )
 {
 	return Matrix4f
 	(
@@ -507,7 +507,7 @@ Matrix4f Matrix4f::uniformScaling( double s )
 }
 
 // static
-Matrix4f Matrix4f::randomRotation( double u0, double u1, double u2 )
+Matrix4f Matrix4f::randomRotation( Real u0, Real u1, Real u2 )
 {
 	return Matrix4f::rotation( Quat4f::randomRotation( u0, u1, u2 ) );
 }
@@ -533,7 +533,7 @@ Matrix4f Matrix4f::lookAt( const Vector3f& eye, const Vector3f& center, const Ve
 }
 
 // static
-Matrix4f Matrix4f::orthographicProjection( double width, double height, double zNear, double zFar, bool directX )
+Matrix4f Matrix4f::orthographicProjection( Real width, Real height, Real zNear, Real zFar, bool directX )
 {
 	Matrix4f m;
 
@@ -559,7 +559,7 @@ Matrix4f Matrix4f::orthographicProjection( double width, double height, double z
 }
 
 // static
-Matrix4f Matrix4f::orthographicProjection( double left, double right, double bottom, double top, double zNear, double zFar, bool directX )
+Matrix4f Matrix4f::orthographicProjection( Real left, Real right, Real bottom, Real top, Real zNear, Real zFar, bool directX )
 {
 	Matrix4f m;
 
@@ -585,9 +585,9 @@ Matrix4f Matrix4f::orthographicProjection( double left, double right, double bot
 }
 
 // static
-Matrix4f Matrix4f::perspectiveProjection( double fLeft, double fRight,
-										 double fBottom, double fTop,
-										 double fZNear, double fZFar,
+Matrix4f Matrix4f::perspectiveProjection( Real fLeft, Real fRight,
+										 Real fBottom, Real fTop,
+										 Real fZNear, Real fZFar,
 										 bool directX )
 {
 	Matrix4f projection; // zero matrix
@@ -613,12 +613,12 @@ Matrix4f Matrix4f::perspectiveProjection( double fLeft, double fRight,
 }
 
 // static
-Matrix4f Matrix4f::perspectiveProjection( double fovYRadians, double aspect, double zNear, double zFar, bool directX )
+Matrix4f Matrix4f::perspectiveProjection( Real fovYRadians, Real aspect, Real zNear, Real zFar, bool directX )
 {
 	Matrix4f m; // zero matrix
 
-	double yScale = 1.f / tanf( 0.5f * fovYRadians );
-	double xScale = yScale / aspect;
+	Real yScale = 1.f / tanf( 0.5f * fovYRadians );
+	Real xScale = yScale / aspect;
 
 	m( 0, 0 ) = xScale;
 	m( 1, 1 ) = yScale;
@@ -639,9 +639,9 @@ Matrix4f Matrix4f::perspectiveProjection( double fovYRadians, double aspect, dou
 }
 
 // static
-Matrix4f Matrix4f::infinitePerspectiveProjection( double fLeft, double fRight,
-												 double fBottom, double fTop,
-												 double fZNear, bool directX )
+Matrix4f Matrix4f::infinitePerspectiveProjection( Real fLeft, Real fRight,
+												 Real fBottom, Real fTop,
+												 Real fZNear, bool directX )
 {
 	Matrix4f projection;
 
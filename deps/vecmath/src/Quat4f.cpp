@@ -24,7 +24,7 @@ Quat4f::Quat4f()
 	m_elements[ 3 ] = 0;
 }
 
-Quat4f::Quat4f( double w, double x, double y, double z )
+Quat4f::Quat4f( Real w, Real x, Real y, Real z )
 {
 	m_elements[ 0 ] = w;
 	m_elements[ 1 ] = x;
@@ -68,32 +68,32 @@ Quat4f::Quat4f( const Vector4f& v )
 	m_elements[ 3 ] = v[ 3 ];
 }
 
-const double& Quat4f::operator [] ( int i ) const
+const Real& Quat4f::operator [] ( int i ) const
 {
 	return m_elements[ i ];
 }
 
-double& Quat4f::operator [] ( int i )
+Real& Quat4f::operator [] ( int i )
 {
 	return m_elements[ i ];
 }
 
-double Quat4f::w() const
+Real Quat4f::w() const
 {
 	return m_elements[ 0 ];
 }
 
-double Quat4f::x() const
+Real Quat4f::x() const
 {
 	return m_elements[ 1 ];
 }
 
-double Quat4f::y() const
+Real Quat4f::y() const
 {
 	return m_elements[ 2 ];
 }
 
-double Quat4f::z() const
+Real Quat4f::z() const
 {
 	return m_elements[ 3 ];
 }
@@ -119,12 +119,12 @@ Vector4f Quat4f::wxyz() const
 	);
 }
 
-double Quat4f::abs() const
+Real Quat4f::abs() const
 {
 	return sqrt( absSquared() );	
 }
 
-double Quat4f::absSquared() const
+Real Quat4f::absSquared() const
 {
 	return
 	(
@@ -137,7 +137,7 @@ double Quat4f::absSquared() const
 
 void Quat4f::normalize()
 {
-	double reciprocalAbs = 1.f / abs();
+	Real reciprocalAbs = 1.f / abs();
 
 	m_elements[ 0 ] *= reciprocalAbs;
 	m_elements[ 1 ] *= reciprocalAbs;
@@ -188,7 +188,7 @@ Quat4f Quat4f::inverse() const
 
 Quat4f Quat4f::log() const
 {
-	double len =
+	Real len =
 		sqrt
 		(
 			m_elements[ 1 ] * m_elements[ 1 ] +
@@ -202,14 +202,14 @@ Quat4f Quat4f::log() const
 	}
 	else
 	{
-		double coeff = acos( m_elements[ 0 ] ) / len;
+		Real coeff = acos( m_elements[ 0 ] ) / len;
 		return Quat4f( 0, m_elements[ 1 ] * coeff, m_elements[ 2 ] * coeff, m_elements[ 3 ] * coeff );
 	}
 }
 
 Quat4f Quat4f::exp() const
 {
-	double theta =
+	Real theta =
 		sqrt
 		(
 			m_elements[ 1 ] * m_elements[ 1 ] +
@@ -223,16 +223,16 @@ Quat4f Quat4f::exp() const
 	}
 	else
 	{
-		double coeff = sin( theta ) / theta;
+		Real coeff = sin( theta ) / theta;
 		return Quat4f( cos( theta ), m_elements[ 1 ] * coeff, m_elements[ 2 ] * coeff, m_elements[ 3 ] * coeff );		
 	}
 }
 
-Vector3f Quat4f::getAxisAngle( double* radiansOut )
+Vector3f Quat4f::getAxisAngle( Real* radiansOut )
 {
-	double theta = acos( w() ) * 2;
-	double vectorNorm = sqrt( x() * x() + y() * y() + z() * z() );
-	double reciprocalVectorNorm = 1.f / vectorNorm;
+	Real theta = acos( w() ) * 2;
+	Real vectorNorm = sqrt( x() * x() + y() * y() + z() * z() );
+	Real reciprocalVectorNorm = 1.f / vectorNorm;
 
 	*radiansOut = theta;
 	return Vector3f
@@ -243,13 +243,13 @@ Vector3f Quat4f::getAxisAngle( double* radiansOut )
 	);
 }
 
-void Quat4f::setAxisAngle( double radians, const Vector3f& axis )
+void Quat4f::setAxisAngle( Real radians, const Vector3f& axis )
 {
 	m_elements[ 0 ] = cos( radians / 2 );
 
-	double sinHalfTheta = sin( radians / 2 );
-	double vectorNorm = axis.length();
-	double reciprocalVectorNorm = 1.f / vectorNorm;
+	Real sinHalfTheta = sin( radians / 2 );
+	Real vectorNorm = axis.length();
+	Real reciprocalVectorNorm = 1.f / vectorNorm;
 
 	m_elements[ 1 ] = axis.x() * sinHalfTheta * reciprocalVectorNorm;
 	m_elements[ 2 ] = axis.y() * sinHalfTheta * reciprocalVectorNorm;
@@ -263,7 +263,7 @@ void Quat4f::print()
 }
 
 // static
-double Quat4f::dot( const Quat4f& q0, const Quat4f& q1 )
+Real Quat4f::dot( const Quat4f& q0, const Quat4f& q1 )
 {
 	return
 	(
@@ -275,18 +275,18 @@ double Quat4f::dot( const Quat4f& q0, const Quat4f& q1 )
 }
 
 // static
-Quat4f Quat4f::lerp( const Quat4f& q0, const Quat4f& q1, double alpha )
+Quat4f Quat4f::lerp( const Quat4f& q0, const Quat4f& q1, Real alpha )
 {
 	return( ( q0 + alpha * ( q1 - q0 ) ).normalized() );
 }
 
 // static
-Quat4f Quat4f::slerp( const Quat4f& a, const Quat4f& b, double t, bool allowFlip )
+Quat4f Quat4f::slerp( const Quat4f& a, const Quat4f& b, Real t, bool allowFlip )
 {
-	double cosAngle = Quat4f::dot( a, b );
+	Real cosAngle = Quat4f::dot( a, b );
 
-	double c1;
-	double c2;
+	Real c1;
+	Real c2;
 
 	// Linear interpolation for close orientations
 	if( ( 1.0f - fabs( cosAngle ) ) < 0.01f )
@@ -297,8 +297,8 @@ Quat4f Quat4f::slerp( const Quat4f& a, const Quat4f& b, double t, bool allowFlip
 	else
 	{
 		// Spherical interpolation
-		double angle = acos( fabs( cosAngle ) );
-		double sinAngle = sin( angle );
+		Real angle = acos( fabs( cosAngle ) );
+		Real sinAngle = sin( angle );
 		c1 = sin( angle * ( 1.0f - t ) ) / sinAngle;
 		c2 = sin( angle * t ) / sinAngle;
 	}
@@ -313,7 +313,7 @@ Quat4f Quat4f::slerp( const Quat4f& a, const Quat4f& b, double t, bool allowFlip
 }
 
 // static
-Quat4f Quat4f::squad( const Quat4f& a, const Quat4f& tanA, const Quat4f& tanB, const Quat4f& b, double t )
+Quat4f Quat4f::squad( const Quat4f& a, const Quat4f& tanA, const Quat4f& tanB, const Quat4f& b, Real t )
 {
 	Quat4f ab = Quat4f::slerp( a, b, t );
 	Quat4f tangent = Quat4f::slerp( tanA, tanB, t, false );
@@ -321,7 +321,7 @@ Quat4f Quat4f::squad( const Quat4f& a, const Quat4f& tanA, const Quat4f& tanB, c
 }
 
 // static
-Quat4f Quat4f::cubicInterpolate( const Quat4f& q0, const Quat4f& q1, const Quat4f& q2, const Quat4f& q3, double t )
+Quat4f Quat4f::cubicInterpolate( const Quat4f& q0, const Quat4f& q1, const Quat4f& q2, const Quat4f& q3, Real t )
 {
 	// geometric construction:
 	//            t
@@ -368,18 +368,18 @@ Quat4f Quat4f::squadTangent( const Quat4f& before, const Quat4f& center, const Q
 // static
 Quat4f Quat4f::fromRotationMatrix( const Matrix3f& m )
 {
-	double x;
-	double y;
-	double z;
-	double w;
+	Real x;
+	Real y;
+	Real z;
+	Real w;
 
 	// Compute one plus the trace of the matrix
-	double onePlusTrace = 1.0f + m( 0, 0 ) + m( 1, 1 ) + m( 2, 2 );
+	Real onePlusTrace = 1.0f + m( 0, 0 ) + m( 1, 1 ) + m( 2, 2 );
 
 	if( onePlusTrace > 1e-5 )
 	{
 		// Direct computation
-		double s = sqrt( onePlusTrace ) * 2.0f;
+		Real s = sqrt( onePlusTrace ) * 2.0f;
 		x = ( m( 2, 1 ) - m( 1, 2 ) ) / s;
 		y = ( m( 0, 2 ) - m( 2, 0 ) ) / s;
 		z = ( m( 1, 0 ) - m( 0, 1 ) ) / s;
@@ -390,7 +390,7 @@ Quat4f Quat4f::fromRotationMatrix( const Matrix3f& m )
 		// Computation depends on major diagonal term
 		if( ( m( 0, 0 ) > m( 1, 1 ) ) & ( m( 0, 0 ) > m( 2, 2 ) ) )
 		{
-			double s = sqrt( 1.0f + m( 0, 0 ) - m( 1, 1 ) - m( 2, 2 ) ) * 2.0f;
+			Real s = sqrt( 1.0f + m( 0, 0 ) - m( 1, 1 ) - m( 2, 2 ) ) * 2.0f;
 			x = 0.25f * s;
 			y = ( m( 0, 1 ) + m( 1, 0 ) ) / s;
 			z = ( m( 0, 2 ) + m( 2, 0 ) ) / s;
@@ -398,7 +398,7 @@ Quat4f Quat4f::fromRotationMatrix( const Matrix3f& m )
 		}
 		else if( m( 1, 1 ) > m( 2, 2 ) )
 		{
-			double s = sqrt( 1.0f + m( 1, 1 ) - m( 0, 0 ) - m( 2, 2 ) ) * 2.0f;
+			Real s = sqrt( 1.0f + m( 1, 1 ) - m( 0, 0 ) - m( 2, 2 ) ) * 2.0f;
 			x = ( m( 0, 1 ) + m( 1, 0 ) ) / s;
 			y = 0.25f * s;
 			z = ( m( 1, 2 ) + m( 2, 1 ) ) / s;
@@ -406,7 +406,7 @@ Quat4f Quat4f::fromRotationMatrix( const Matrix3f& m )
 		}
 		else
 		{
-			double s = sqrt( 1.0f + m( 2, 2 ) - m( 0, 0 ) - m( 1, 1 ) ) * 2.0f;
+			Real s = sqrt( 1.0f + m( 2, 2 ) - m( 0, 0 ) - m( 1, 1 ) ) * 2.0f;
 			x = ( m( 0, 2 ) + m( 2, 0 ) ) / s;
 			y = ( m( 1, 2 ) + m( 2, 1 ) ) / s;
 			z = 0.25f * s;
@@ -425,12 +425,12 @@ Quat4f Quat4f::fromRotatedBasis( const Vector3f& x, const Vector3f& y, const Vec
 }
 
 // static
-Quat4f Quat4f::randomRotation( double u0, double u1, double u2 )
+Quat4f Quat4f::randomRotation( Real u0, Real u1, Real u2 )
 {
-	double z = u0;
-	double theta = static_cast< double >( 2.f * M_PI * u1 );
-	double r = sqrt( 1.f - z * z );
-	double w = static_cast< double >( M_PI * u2 );
+	Real z = u0;
+	Real theta = static_cast< Real >( 2.f * M_PI * u1 );
+	Real r = sqrt( 1.f - z * z );
+	Real w = static_cast< Real >( M_PI * u2 );
 
 	return Quat4f
 	(
@@ -478,7 +478,7 @@ Quat4f operator * ( const Quat4f& q0, const Quat4f& q1 )
 	);
 }
 
-Quat4f operator * ( double f, const Quat4f& q )
+Quat4f operator * ( Real f, const Quat4f& q )
 {
 	return Quat4f
 	(
@@ -489,7 +489,7 @@ Quat4f operator * ( double f, const Quat4f& q )
 	);
 }
 
-Quat4f operator * ( const Quat4f& q, double f )
+Quat4f operator * ( const Quat4f& q, Real f )
 {
 	return Quat4f
 	(
@@ -6,7 +6,7 @@
 #include "Vector2f.h"
 #include "Vector3f.h"
 
-Vector4f::Vector4f( double f )
+Vector4f::Vector4f( Real f )
 {
 	m_elements[ 0 ] = f;
 	m_elements[ 1 ] = f;
@@ -14,7 +14,7 @@ Vector4f::Vector4f( double f )
 	m_elements[ 3 ] = f;
 }
 
-Vector4f::Vector4f( double fx, double fy, double fz, double fw )
+Vector4f::Vector4f( Real fx, Real fy, Real fz, Real fw )
 {
 	m_elements[0] = fx;
 	m_elements[1] = fy;
@@ -22,7 +22,7 @@ Vector4f::Vector4f( double fx, double fy, double fz, double fw )
 	m_elements[3] = fw;
 }
 
-Vector4f::Vector4f( double buffer[ 4 ] )
+Vector4f::Vector4f( Real buffer[ 4 ] )
 {
 	m_elements[ 0 ] = buffer[ 0 ];
 	m_elements[ 1 ] = buffer[ 1 ];
@@ -30,7 +30,7 @@ Vector4f::Vector4f( double buffer[ 4 ] )
 	m_elements[ 3 ] = buffer[ 3 ];
 }
 
-Vector4f::Vector4f( const Vector2f& xy, double z, double w )
+Vector4f::Vector4f( const Vector2f& xy, Real z, Real w )
 {
 	m_elements[0] = xy.x();
 	m_elements[1] = xy.y();
@@ -38,7 +38,7 @@ Vector4f::Vector4f( const Vector2f& xy, double z, double w )
 	m_elements[3] = w;
 }
 
-Vector4f::Vector4f( double x, const Vector2f& yz, double w )
+Vector4f::Vector4f( Real x, const Vector2f& yz, Real w )
 {
 	m_elements[0] = x;
 	m_elements[1] = yz.x();
@@ -46,7 +46,7 @@ Vector4f::Vector4f( double x, const Vector2f& yz, double w )
 	m_elements[3] = w;
 }
 
-Vector4f::Vector4f( double x, double y, const Vector2f& zw )
+Vector4f::Vector4f( Real x, Real y, const Vector2f& zw )
 {
 	m_elements[0] = x;
 	m_elements[1] = y;
@@ -62,7 +62,7 @@ Vector4f::Vector4f( const Vector2f& xy, const Vector2f& zw )
 	m_elements[3] = zw.y();
 }
 
-Vector4f::Vector4f( const Vector3f& xyz, double w )
+Vector4f::Vector4f( const Vector3f& xyz, Real w )
 {
 	m_elements[0] = xyz.x();
 	m_elements[1] = xyz.y();
@@ -70,7 +70,7 @@ Vector4f::Vector4f( const Vector3f& xyz, double w )
 	m_elements[3] = w;
 }
 
-Vector4f::Vector4f( double x, const Vector3f& yzw )
+Vector4f::Vector4f( Real x, const Vector3f& yzw )
 {
 	m_elements[0] = x;
 	m_elements[1] = yzw.x();
@@ -98,52 +98,52 @@ Vector4f& Vector4f::operator = ( const Vector4f& rv )
 	return *this;
 }
 
-const double& Vector4f::operator [] ( int i ) const
+const Real& Vector4f::operator [] ( int i ) const
 {
 	return m_elements[ i ];
 }
 
-double& Vector4f::operator [] ( int i )
+Real& Vector4f::operator [] ( int i )
 {
 	return m_elements[ i ];
 }
 
-double& Vector4f::x()
+Real& Vector4f::x()
 {
 	return m_elements[ 0 ];
 }
 
-double& Vector4f::y()
+Real& Vector4f::y()
 {
 	return m_elements[ 1 ];
 }
 
-double& Vector4f::z()
+Real& Vector4f::z()
 {
 	return m_elements[ 2 ];
 }
 
-double& Vector4f::w()
+Real& Vector4f::w()
 {
 	return m_elements[ 3 ];
 }
 
-double Vector4f::x() const
+Real Vector4f::x() const
 {
 	return m_elements[0];
 }
 
-double Vector4f::y() const
+Real Vector4f::y() const
 {
 	return m_elements[1];
 }
 
-double Vector4f::z() const
+Real Vector4f::z() const
 {
 	return m_elements[2];
 }
 
-double Vector4f::w() const
+Real Vector4f::w() const
 {
 	return m_elements[3];
 }
@@ -208,19 +208,19 @@ Vector3f Vector4f::wxz() const
 	return Vector3f( m_elements[3], m_elements[0], m_elements[2] );
 }
 
-double Vector4f::abs() const
+Real Vector4f::abs() const
 {
 	return sqrt( m_elements[0] * m_elements[0] + m_elements[1] * m_elements[1] + m_elements[2] * m_elements[2] + m_elements[3] * m_elements[3] );
 }
 
-double Vector4f::absSquared() const
+Real Vector4f::absSquared() const
 {
 	return( m_elements[0] * m_elements[0] + m_elements[1] * m_elements[1] + m_elements[2] * m_elements[2] + m_elements[3] * m_elements[3] );
 }
 
 void Vector4f::normalize()
 {
-	double norm = sqrt( m_elements[0] * m_elements[0] + m_elements[1] * m_elements[1] + m_elements[2] * m_elements[2] + m_elements[3] * m_elements[3] );
+	Real norm = sqrt( m_elements[0] * m_elements[0] + m_elements[1] * m_elements[1] + m_elements[2] * m_elements[2] + m_elements[3] * m_elements[3] );
 	m_elements[0] = m_elements[0] / norm;
 	m_elements[1] = m_elements[1] / norm;
 	m_elements[2] = m_elements[2] / norm;
@@ -229,7 +229,7 @@ void Vector4f::normalize()
 
 Vector4f Vector4f::normalized() const
 {
-	double length = abs();
+	Real length = abs();
 	return Vector4f
 		(
 			m_elements[0] / length,
@@ -282,12 +282,12 @@ void Vector4f::negate()
 	m_elements[3] = -m_elements[3];
 }
 
-Vector4f::operator const double* () const
+Vector4f::operator const Real* () const
 {
 	return m_elements;
 }
 
-Vector4f::operator double* ()
+Vector4f::operator Real* ()
 {
 	return m_elements;
 }
@@ -299,13 +299,13 @@ void Vector4f::print() const
 }
 
 // static
-double Vector4f::dot( const Vector4f& v0, const Vector4f& v1 )
+Real Vector4f::dot( const Vector4f& v0, const Vector4f& v1 )
 {
 	return v0.x() * v1.x() + v0.y() * v1.y() + v0.z() * v1.z() + v0.w() * v1.w();
 }
 
 // static
-Vector4f Vector4f::lerp( const Vector4f& v0, const Vector4f& v1, double alpha )
+Vector4f Vector4f::lerp( const Vector4f& v0, const Vector4f& v1, Real alpha )
 {
 	return alpha * ( v1 - v0 ) + v0;
 }
@@ -339,17 +339,17 @@ Vector4f operator - ( const Vector4f& v )
 	return Vector4f( -v.x(), -v.y(), -v.z(), -v.w() );
 }
 
-Vector4f operator * ( double f, const Vector4f& v )
+Vector4f operator * ( Real f, const Vector4f& v )
 {
 	return Vector4f( f * v.x(), f * v.y(), f * v.z(), f * v.w() );
 }
 
-Vector4f operator * ( const Vector4f& v, double f )
+Vector4f operator * ( const Vector4f& v, Real f )
 {
 	return Vector4f( f * v.x(), f * v.y(), f * v.z(), f * v.w() );
 }
 
-Vector4f operator / ( const Vector4f& v, double f )
+Vector4f operator / ( const Vector4f& v, Real f )
 {
     return Vector4f( v[0] / f, v[1] / f, v[2] / f, v[3] / f );
 }
@@ -0,0 +1,166 @@
+#ifndef ADAPTIVE_SAMPLER_H
+#define ADAPTIVE_SAMPLER_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <vecmath.h>
+
+#include "camera.hpp"
+#include "image.hpp"
+#include "photonmapping.hpp"
+#include "render_settings.hpp"
+#include "wavefront.hpp"
+
+// Per-pixel sample accumulation for the render pass and adaptive
+// anti-aliasing. Without anti-aliasing a pixel is traced once through its
+// centre (lenSampleNum times through the lens with DOF). With it, the first
+// pass takes jittered samples under DOF, at least lenSampleNum and
+// aaMinSamples of them, and only the centre sample otherwise; the refine
+// pass then adds samples to pixels whose luminance differs from a neighbour
+// by more than aaContrast or whose standard error is above aaThreshold,
+// until the error is small enough or aaMaxSamples is reached.
+class AdaptiveSampler {
+public:
+    AdaptiveSampler(Camera *camera, PhotonMapping *photonMapping, const RenderSettings &settings)
+        : camera(camera), photonMapping(photonMapping), settings(settings) {
+        W = camera->getWidth(), H = camera->getHeight();
+        sum.assign(W * H, Vector3f(0));
+        lumSum.assign(W * H, 0);
+        lumSq.assign(W * H, 0);
+        count.assign(W * H, 0);
+    }
+
+    void initial(int x, int y) {
+        addSamples(x, y, initialSamples());
+    }
+
+    // initial() for every pixel of [x0, x1) x [y0, y1), with all the camera
+    // rays traced as one wavefront batch.
+    void initialBatch(int x0, int y0, int x1, int y1, Wavefront &wavefront) {
+        std::vector<Ray> rays;
+        std::vector<int> pixels;
+        int n = initialSamples();
+        for (int x = x0; x < x1; ++x)
+            for (int y = y0; y < y1; ++y)
+                for (int k = 0; k < n; ++k) {
+                    rays.push_back(cameraRay(x, y, count[y * W + x] + k));
+                    pixels.push_back(y * W + x);
+                }
+        std::vector<Vector3f> colors;
+        wavefront.trace(rays, colors);
+        for (size_t i = 0; i < rays.size(); ++i)
+            record(pixels[i], colors[i]);
+    }
+
+    // Must run after initial() has finished for every pixel; returns the
+    // number of samples added.
+    int refine(int x, int y) {
+        int p = y * W + x;
+        Real lum = lumSum[p] / count[p], contrast = 0;
+        for (int dx = -1; dx <= 1; ++dx)
+            for (int dy = -1; dy <= 1; ++dy) {
+                int nx = x + dx, ny = y + dy;
+                if (nx < 0 || nx >= W || ny < 0 || ny >= H) continue;
+                int q = ny * W + nx;
+                contrast = std::max(contrast, std::fabs(baseLum[q] - lum));
+            }
+        int before = count[p];
+        if (contrast <= settings.aaContrast && standardError(p) <= settings.aaThreshold)
+            return 0;
+        int maxSamples = std::max(settings.aaMaxSamples, camera->isDOF ? camera->lenSampleNum : 1);
+        if (count[p] < settings.aaMinSamples)
+            addSamples(x, y, std::min(settings.aaMinSamples, maxSamples) - count[p]);
+        while (count[p] < maxSamples && standardError(p) > settings.aaThreshold)
+            addSamples(x, y, std::min(count[p], maxSamples - count[p]));
+        return count[p] - before;
+    }
+
+    // Freeze the luminance of the first pass for the contrast test.
+    void finishInitial() {
+        baseLum.resize(W * H);
+        for (int p = 0; p < W * H; ++p)
+            baseLum[p] = lumSum[p] / std::max(1, count[p]);
+    }
+
+    void resolve(Image &img) const {
+        for (int y = 0; y < H; ++y)
+            for (int x = 0; x < W; ++x) {
+                int p = y * W + x;
+                img.SetPixel(x, y, sum[p] / std::max(1, count[p]));
+            }
+    }
+
+private:
+    Real standardError(int p) const {
+        int n = count[p];
+        if (n < 2) return 0;
+        Real mean = lumSum[p] / n;
+        Real var = std::max(Real(0), (lumSq[p] - n * mean * mean) / (n - 1));
+        return std::sqrt(var / n);
+    }
+
+    // Sample k of a pixel: the centre first, then the QMC sampler's first two
+    // dimensions or, with the random sampler, an R2 low-discrepancy sequence
+    // rotated per pixel so neighbouring pixels do not line up.
+    Vector2f subPixel(int x, int y, int k, SampleStream &stream) const {
+        if (k == 0 && !camera->isDOF)
+            return Vector2f(x, y);
+        if (photonMapping->sampler.getType() != SAMPLER_RANDOM)
+            return Vector2f(x + stream.next() - 0.5, y + stream.next() - 0.5);
+        unsigned h = (unsigned)x * 73856093u ^ (unsigned)y * 19349663u;
+        Real sx = (h & 0xffff) / 65536.0, sy = (h >> 16 & 0xffff) / 65536.0;
+        Real u = sx + k * 0.7548776662466927, v = sy + k * 0.5698402909980532;
+        return Vector2f(x + (u - std::floor(u)) - 0.5, y + (v - std::floor(v)) - 0.5);
+    }
+
+    int initialSamples() const {
+        if (!camera->isDOF)
+            return 1;
+        if (!settings.antialiasing)
+            return camera->lenSampleNum;
+        // never fewer lens samples than without anti-aliasing
+        return std::max(camera->lenSampleNum, std::max(1, settings.aaMinSamples));
+    }
+
+    Ray cameraRay(int x, int y, int k) {
+        bool jitter = settings.antialiasing || !camera->isDOF;
+        SampleStream stream(&photonMapping->sampler, k, y * W + x);
+        Ray camRay = camera->generateRay(jitter ? subPixel(x, y, k, stream) : Vector2f(x, y));
+        if (!camera->isDOF)
+            return camRay;
+        Vector3f camCenter = camera->center;
+        Vector3f focusPoint = camRay.pointAtParameter(camera->focusDist);
+        Vector3f dirX = Vector3f::cross(camera->direction, camera->up).normalized();
+        Vector3f dirY = Vector3f::cross(camera->direction, dirX).normalized();
+        // modify the ray for DOF
+        Real dx=( stream.next() * 2 - 1 ), dy = ( stream.next() * 2 - 1 ), square = dx*dx+dy*dy;
+        dx /= sqrt(square), dy /= sqrt(square);
+        Vector3f newO = camCenter + camera->lenRadius*dx*dirX + camera->lenRadius*dy*dirY; // lenRadius: lens aperture
+        return Ray(newO, (focusPoint-newO).normalized());
+    }
+
+    void record(int p, const Vector3f &c) {
+        Real l = c.avg();
+        sum[p] += c;
+        lumSum[p] += l;
+        lumSq[p] += l * l;
+        count[p]++;
+    }
+
+    void addSamples(int x, int y, int n) {
+        int p = y * W + x;
+        for (int i = 0; i < n; ++i)
+            record(p, photonMapping->backwardTracing(cameraRay(x, y, count[p]), 1));
+    }
+
+    Camera *camera;
+    PhotonMapping *photonMapping;
+    const RenderSettings &settings;
+    int W, H;
+    std::vector<Vector3f> sum;
+    std::vector<Real> lumSum, lumSq, baseLum;
+    std::vector<int> count;
+};
+
+#endif // ADAPTIVE_SAMPLER_H
@@ -0,0 +1,66 @@
+#ifndef ALIAS_TABLE_H
+#define ALIAS_TABLE_H
+
+#include <algorithm>
+#include <vector>
+#include <vecmath.h>
+
+// Picks index i with probability proportional to weights[i] in O(1), using
+// Vose's alias table: each of the n columns holds probability 1/n, split
+// between the column's own index and at most one alias. Used to choose the
+// emitting light by power and the projection map cell of a photon.
+class AliasTable {
+public:
+    AliasTable() : total(0) {}
+
+    AliasTable(const std::vector<Real> &weights) : prob(weights.size()), alias(weights.size()), weight(weights) {
+        int n = weights.size();
+        total = 0;
+        for (int i = 0; i < n; ++i)
+            total += weight[i];
+        std::vector<int> small, large;
+        std::vector<Real> scaled(n);
+        for (int i = 0; i < n; ++i) {
+            scaled[i] = total > 0 ? weight[i] * n / total : 1;
+            (scaled[i] < 1 ? small : large).push_back(i);
+        }
+        while (!small.empty() && !large.empty()) {
+            int s = small.back(), l = large.back();
+            small.pop_back();
+            prob[s] = scaled[s], alias[s] = l;
+            scaled[l] -= 1 - scaled[s];
+            if (scaled[l] < 1) {
+                large.pop_back();
+                small.push_back(l);
+            }
+        }
+        // whatever is left is 1 up to rounding
+        for (size_t i = 0; i < large.size(); ++i)
+            prob[large[i]] = 1, alias[large[i]] = large[i];
+        for (size_t i = 0; i < small.size(); ++i)
+            prob[small[i]] = 1, alias[small[i]] = small[i];
+    }
+
+    // u1 and u2 uniform in [0, 1).
+    int sample(Real u1, Real u2) const {
+        int n = prob.size();
+        int i = std::min(int(u1 * n), n - 1);
+        return u2 < prob[i] ? i : alias[i];
+    }
+
+    Real pdf(int i) const {
+        return total > 0 ? weight[i] / total : Real(1) / weight.size();
+    }
+
+    Real getTotal() const {
+        return total;
+    }
+
+private:
+    std::vector<Real> prob;
+    std::vector<int> alias;
+    std::vector<Real> weight;
+    Real total;
+};
+
+#endif // ALIAS_TABLE_H
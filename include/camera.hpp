@@ -9,7 +9,7 @@
 
 class Camera {
 public:
-    Camera(const Vector3f &center, const Vector3f &direction, const Vector3f &up, int imgW, int imgH, int isDOF, double lenRadius, int lenSampleNum, double focusDist) {
+    Camera(const Vector3f &center, const Vector3f &direction, const Vector3f &up, int imgW, int imgH, int isDOF, Real lenRadius, int lenSampleNum, Real focusDist) {
         this->center = center;
         this->direction = direction.normalized();
         this->horizontal = Vector3f::cross(this->direction, up).normalized();
@@ -26,6 +26,9 @@ public:
     virtual Ray generateRay(const Vector2f &point) = 0;
     virtual ~Camera() = default;
 
+    // Angle between the rays of neighbouring pixels, 0 if not meaningful.
+    virtual Real getPixelSpread() const { return 0; }
+
     int getWidth() const { return width; }
     int getHeight() const { return height; }
     
@@ -39,9 +42,9 @@ public:
     int height;
     // parameters for DOF
     bool isDOF = false;
-    double lenRadius;
+    Real lenRadius;
     int lenSampleNum;
-    double focusDist;
+    Real focusDist;
 };
 
 // TODO: Implement Perspective camera
@@ -50,22 +53,26 @@ class PerspectiveCamera : public Camera {
 
 public:
     PerspectiveCamera(const Vector3f &center, const Vector3f &direction,
-            const Vector3f &up, int imgW, int imgH, double angle, int isDOF, double lenRadius, int lenSampleNum, double focusDist) : Camera(center, direction, up, imgW, imgH, isDOF, lenRadius, lenSampleNum, focusDist) {
+            const Vector3f &up, int imgW, int imgH, Real angle, int isDOF, Real lenRadius, int lenSampleNum, Real focusDist) : Camera(center, direction, up, imgW, imgH, isDOF, lenRadius, lenSampleNum, focusDist) {
         // angle is in radian.
         this->angle = angle;
-        this->dist = 0.5 * (double)imgH / tan (angle/2.0);
+        this->dist = 0.5 * (Real)imgH / tan (angle/2.0);
     }
 
     Ray generateRay(const Vector2f &point) override {
         // 
-        Vector3f dRw = (point.x() - (double)(getWidth())/2.0) * horizontal + (point.y() - (double)(getHeight())/2.0) * up + dist * direction;
+        Vector3f dRw = (point.x() - (Real)(getWidth())/2.0) * horizontal + (point.y() - (Real)(getHeight())/2.0) * up + dist * direction;
         dRw = dRw.normalized();
         return Ray(center, dRw);
     }
 
+    Real getPixelSpread() const override {
+        return 1 / dist;
+    }
+
 protected:
-    double angle;
-    double dist;
+    Real angle;
+    Real dist;
 };
 
 #endif //CAMERA_H
@@ -5,6 +5,7 @@
 #include "object3d.hpp"
 #include "ray.hpp"
 #include "hit.hpp"
+#include "primitive_list.hpp"
 #include <iostream>
 #include <vector>
 
@@ -26,16 +27,36 @@ public:
 
     }
 
-    bool intersect(const Ray &r, Hit &h, double tmin) override {
-        bool flag = false;
-        for (int i = 0; i < objects.size(); ++i) {
-            flag |= objects[i]->intersect(r, h, tmin);
+    bool intersect(const Ray &r, Hit &h, Real tmin) override {
+        bool flag = spheres.intersect(r, h, tmin);
+        flag |= planes.intersect(r, h, tmin);
+        for (int i = 0; i < others.size(); ++i) {
+            flag |= others[i]->intersect(r, h, tmin);
         }
         return flag;
     }
 
+    // Spheres and planes go into flat per-type lists; nested groups are
+    // merged into this one. Meshes, transforms and triangles keep their own
+    // intersect (meshes already have a kd-tree).
     void addObject(int index, Object3D *obj) {
         objects.push_back(obj);
+        if (Sphere *s = dynamic_cast<Sphere*>(obj))
+            spheres.add(s);
+        else if (Plane *p = dynamic_cast<Plane*>(obj))
+            planes.add(p);
+        else if (Group *g = dynamic_cast<Group*>(obj)) {
+            spheres.append(g->spheres);
+            planes.append(g->planes);
+            others.insert(others.end(), g->others.begin(), g->others.end());
+        }
+        else
+            others.push_back(obj);
+    }
+
+    void findMeshes(const Matrix4f &toWorld, std::vector<std::pair<Mesh*, Matrix4f> > &out) override {
+        for (size_t i = 0; i < objects.size(); ++i)
+            objects[i]->findMeshes(toWorld, out);
     }
 
     int getGroupSize() {
@@ -44,6 +65,9 @@ public:
 
 private:
     std::vector<Object3D*> objects;
+    SphereList spheres;
+    PlaneList planes;
+    std::vector<Object3D*> others;
 };
 
 #endif
@@ -5,40 +5,54 @@
 #include "ray.hpp"
 
 class Material;
+class Object3D;
+class Transform;
 
+#define MAX_INSTANCE_DEPTH 8
+
+// intersect() only records t, the primitive and the transforms above it.
+// Normal, material and texture coordinates are filled in afterwards for the
+// closest hit only (see evalHit in transform.hpp).
 class Hit {
 public:
 
     // constructors
     Hit() {
         material = nullptr;
+        object = nullptr;
+        numInstances = 0;
         t = 1e38;
+        x = y = 0;
+        barycentric = Vector2f(0);
+        hasBaked = false;
     }
 
-    Hit(double _t, Material *m, const Vector3f &n) {
+    Hit(Real _t, Material *m, const Vector3f &n) {
         t = _t;
         material = m;
         normal = n;
+        object = nullptr;
+        numInstances = 0;
+        x = y = 0;
+        barycentric = Vector2f(0);
+        hasBaked = false;
     }
 
-    Hit(const Hit &h) {
-        t = h.t;
-        material = h.material;
-        normal = h.normal;
-    }
+    Hit(const Hit &h) = default;
+    Hit &operator=(const Hit &h) = default;
 
     // destructor
     ~Hit() = default;
 
-    double getT() const {
+    Real getT() const {
         return t;
     }
 
-    double getX() const {
+    Real getX() const {
         return x;
     }
 
-    double getY() const {
+    Real getY() const {
         return y;
     }
 
@@ -50,7 +64,25 @@ public:
         return normal;
     }
 
-    void set(double t, Material *m, const Vector3f &n, double x = 0, double y = 0) {
+    const Object3D *getObject() const {
+        return object;
+    }
+
+    // Weights of vertices 1 and 2 at a triangle hit (vertex 0 gets the rest).
+    const Vector2f &getBarycentric() const {
+        return barycentric;
+    }
+
+    int getNumInstances() const {
+        return numInstances;
+    }
+
+    // 0 is the innermost transform
+    const Transform *getInstance(int i) const {
+        return instances[i];
+    }
+
+    void set(Real t, Material *m, const Vector3f &n, Real x = 0, Real y = 0) {
         this->t = t;
         this->material = m;
         this->normal = n;
@@ -58,11 +90,50 @@ public:
         this->y = y;
     }
 
+    void setNormal(const Vector3f &n) {
+        normal = n;
+    }
+
+    // Irradiance baked into the mesh at the hit, if any (see Mesh::setBaked).
+    bool hasBakedIrradiance() const {
+        return hasBaked;
+    }
+
+    const Vector3f &getBakedIrradiance() const {
+        return baked;
+    }
+
+    void setBakedIrradiance(const Vector3f &e) {
+        baked = e;
+        hasBaked = true;
+    }
+
+    // A primitive found a closer intersection.
+    void record(Real t, const Object3D *obj, const Vector2f &barycentric = Vector2f(0)) {
+        this->t = t;
+        object = obj;
+        this->barycentric = barycentric;
+        numInstances = 0;
+        hasBaked = false;
+    }
+
+    // A transform whose subtree produced the current hit, called on the way out.
+    void pushInstance(const Transform *tr) {
+        assert(numInstances < MAX_INSTANCE_DEPTH);
+        instances[numInstances++] = tr;
+    }
+
 private:
-    double t;
+    Real t;
     Material *material;
     Vector3f normal;
-    double x, y;
+    Real x, y;
+    Vector2f barycentric;
+    const Object3D *object;
+    const Transform *instances[MAX_INSTANCE_DEPTH];
+    int numInstances;
+    bool hasBaked;
+    Vector3f baked;
 };
 
 inline std::ostream &operator<<(std::ostream &os, const Hit &h) {
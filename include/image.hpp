@@ -2,6 +2,7 @@
 #define IMAGE_H
 
 #include <cassert>
+#include <cstddef>
 #include <vecmath.h>
 
 // Simple image class
@@ -53,6 +54,8 @@ public:
 
     void SaveTGA(const char *filename) const;
 
+    static Image *LoadBMP(const char *filename);
+
     int SaveBMP(const char *filename);
 
     void SaveImage(const char *filename);
@@ -65,4 +68,10 @@ private:
 
 };
 
+// Check the header of a binary PPM (P6, 8-bit) or uncompressed 24-bit TGA
+// held in memory. Returns the first byte of the pixel rows (top row first),
+// or NULL if the file is not supported or truncated.
+const unsigned char *ReadPPMHeader(const char *data, size_t size, int &width, int &height);
+const unsigned char *ReadTGAHeader(const char *data, size_t size, int &width, int &height);
+
 #endif // IMAGE_H
@@ -0,0 +1,87 @@
+#ifndef IMPORTANCE_MAP_H
+#define IMPORTANCE_MAP_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vecmath.h>
+
+// Visual importance over a sparse grid of cubic cells, one gather radius on
+// a side. Importance particles traced from the camera add their weight to
+// the cell of every diffuse surface they reach. finish() normalizes the
+// values to [0, 1] and also records the neighbours of every such cell,
+// because photons there can still fall within the gather radius of a
+// visible point.
+class ImportanceMap {
+public:
+    ImportanceMap(Real cellSize) : cellSize(cellSize), maxValue(0) {}
+
+    // Not thread-safe; merge per-thread maps with merge().
+    void add(const Vector3f &p, Real w) {
+        cells[key(p)] += w;
+    }
+
+    void merge(const ImportanceMap &other) {
+        for (auto it = other.cells.begin(); it != other.cells.end(); ++it)
+            cells[it->first] += it->second;
+    }
+
+    void finish() {
+        maxValue = 0;
+        for (auto it = cells.begin(); it != cells.end(); ++it)
+            maxValue = std::max(maxValue, it->second);
+        std::unordered_map<uint64_t, Real> grown(cells);
+        for (auto it = cells.begin(); it != cells.end(); ++it) {
+            int x, y, z;
+            unpack(it->first, x, y, z);
+            for (int dx = -1; dx <= 1; ++dx)
+                for (int dy = -1; dy <= 1; ++dy)
+                    for (int dz = -1; dz <= 1; ++dz)
+                        grown.insert(std::make_pair(pack(x + dx, y + dy, z + dz), Real(0)));
+        }
+        cells.swap(grown);
+    }
+
+    // Whether photons at p can be seen through a gather.
+    bool visible(const Vector3f &p) const {
+        return cells.find(key(p)) != cells.end();
+    }
+
+    // Importance at p relative to the most important cell.
+    Real get(const Vector3f &p) const {
+        auto it = cells.find(key(p));
+        return it == cells.end() || maxValue <= 0 ? 0 : it->second / maxValue;
+    }
+
+    Real getCellSize() const {
+        return cellSize;
+    }
+
+    int numCells() const {
+        return cells.size();
+    }
+
+private:
+    uint64_t key(const Vector3f &p) const {
+        return pack((int)std::floor(p.x() / cellSize), (int)std::floor(p.y() / cellSize), (int)std::floor(p.z() / cellSize));
+    }
+
+    // 21 bits per axis
+    static uint64_t pack(int x, int y, int z) {
+        return (uint64_t)(x & 0x1fffff) << 42 | (uint64_t)(y & 0x1fffff) << 21 | (uint64_t)(z & 0x1fffff);
+    }
+
+    static void unpack(uint64_t k, int &x, int &y, int &z) {
+        // sign-extend each 21-bit field
+        x = (int)((int64_t)(k >> 42 << 43) >> 43);
+        y = (int)((int64_t)((k >> 21 & 0x1fffff) << 43) >> 43);
+        z = (int)((int64_t)((k & 0x1fffff) << 43) >> 43);
+    }
+
+    Real cellSize;
+    Real maxValue;
+    std::unordered_map<uint64_t, Real> cells;
+};
+
+#endif // IMPORTANCE_MAP_H
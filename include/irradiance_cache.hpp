@@ -0,0 +1,151 @@
+#ifndef IRRADIANCE_CACHE_H
+#define IRRADIANCE_CACHE_H
+
+#include <algorithm>
+#include <cmath>
+#include <pthread.h>
+#include <vector>
+#include <vecmath.h>
+
+// Irradiance computed by one final gather, with Ward and Heckbert's
+// rotational and translational gradients of each color channel.
+struct IrradianceRecord {
+    Vector3f position, normal;
+    Vector3f irradiance;
+    // harmonic mean distance to the surfaces seen by the gather
+    Real radius;
+    Vector3f rotGrad[3], transGrad[3];
+
+    // Irradiance extrapolated to (p, n) with the gradients.
+    Vector3f extrapolate(const Vector3f &p, const Vector3f &n) const {
+        Vector3f axis = Vector3f::cross(normal, n), d = p - position;
+        Vector3f res = irradiance;
+        for (int c = 0; c < 3; ++c)
+            res[c] += Vector3f::dot(axis, rotGrad[c]) + Vector3f::dot(d, transGrad[c]);
+        return Vector3f(std::max(res[0], Real(0)), std::max(res[1], Real(0)), std::max(res[2], Real(0)));
+    }
+};
+
+// Ward's irradiance cache: records in an octree, each stored in the nodes
+// its region of influence overlaps at about its own size, so a lookup only
+// visits the nodes on the path to the query point. A record is used at
+// (p, n) if its weight 1 / (|p - x_i| / R_i + sqrt(1 - n . n_i)) exceeds
+// 1 / accuracy and it is not in front of p. Render threads look up and
+// insert concurrently under a read-write lock.
+class IrradianceCache {
+public:
+    IrradianceCache(const Vector3f &lo, const Vector3f &hi, Real accuracy) : accuracy(accuracy) {
+        nodes.push_back(Node());
+        nodes[0].lo = lo, nodes[0].hi = hi;
+        pthread_rwlock_init(&lock, NULL);
+    }
+
+    ~IrradianceCache() {
+        pthread_rwlock_destroy(&lock);
+    }
+
+    IrradianceCache(const IrradianceCache &) = delete;
+    IrradianceCache &operator=(const IrradianceCache &) = delete;
+
+    // Weighted average of the usable records; false if there are none.
+    bool lookup(const Vector3f &p, const Vector3f &n, Vector3f &irradiance) {
+        pthread_rwlock_rdlock(&lock);
+        Vector3f sum(0);
+        Real weightSum = 0;
+        int idx = 0;
+        while (idx != -1) {
+            const Node &node = nodes[idx];
+            for (size_t i = 0; i < node.records.size(); ++i) {
+                const IrradianceRecord &rec = records[node.records[i]];
+                Real w = weight(rec, p, n);
+                if (w <= 1 / accuracy) continue;
+                sum += w * rec.extrapolate(p, n);
+                weightSum += w;
+            }
+            idx = childContaining(node, p);
+        }
+        pthread_rwlock_unlock(&lock);
+        if (weightSum <= 0) return false;
+        irradiance = sum / weightSum;
+        return true;
+    }
+
+    void insert(const IrradianceRecord &rec) {
+        pthread_rwlock_wrlock(&lock);
+        records.push_back(rec);
+        Real r = accuracy * rec.radius;
+        insert(0, records.size() - 1, rec.position - Vector3f(r), rec.position + Vector3f(r), 0);
+        pthread_rwlock_unlock(&lock);
+    }
+
+    int numRecords() const {
+        return records.size();
+    }
+
+private:
+    struct Node {
+        Vector3f lo, hi;
+        int children[8];
+        std::vector<int> records;
+        Node() {
+            std::fill(children, children + 8, -1);
+        }
+    };
+
+    static const int MAX_DEPTH = 16;
+
+    Real weight(const IrradianceRecord &rec, const Vector3f &p, const Vector3f &n) const {
+        Vector3f d = p - rec.position;
+        // records in front of p see something p does not
+        if (Vector3f::dot(d, rec.normal + n) < -1e-3 * rec.radius) return 0;
+        Real cosN = std::min(Real(1), Vector3f::dot(n, rec.normal));
+        return 1 / (d.length() / rec.radius + std::sqrt(1 - cosN) + 1e-6);
+    }
+
+    int childContaining(const Node &node, const Vector3f &p) const {
+        Vector3f mid = (node.lo + node.hi) / 2;
+        int c = (p.x() > mid.x()) | (p.y() > mid.y()) << 1 | (p.z() > mid.z()) << 2;
+        return node.children[c];
+    }
+
+    void insert(int idx, int rec, const Vector3f &lo, const Vector3f &hi, int depth) {
+        Vector3f size = nodes[idx].hi - nodes[idx].lo;
+        Real side = std::max(size.x(), std::max(size.y(), size.z()));
+        // keep records in nodes no smaller than their region, and records
+        // reaching outside the cache in the root
+        if (depth == MAX_DEPTH || side < 2 * (hi.x() - lo.x()) || (depth == 0 && !inside(nodes[idx], lo, hi))) {
+            nodes[idx].records.push_back(rec);
+            return;
+        }
+        Vector3f mid = (nodes[idx].lo + nodes[idx].hi) / 2;
+        for (int c = 0; c < 8; ++c) {
+            Vector3f clo, chi;
+            for (int a = 0; a < 3; ++a) {
+                bool upper = (c >> a) & 1;
+                clo[a] = upper ? mid[a] : nodes[idx].lo[a];
+                chi[a] = upper ? nodes[idx].hi[a] : mid[a];
+            }
+            if (hi.x() < clo.x() || lo.x() > chi.x() || hi.y() < clo.y() || lo.y() > chi.y() ||
+                hi.z() < clo.z() || lo.z() > chi.z())
+                continue;
+            if (nodes[idx].children[c] == -1) {
+                nodes[idx].children[c] = nodes.size();
+                nodes.push_back(Node());
+                nodes.back().lo = clo, nodes.back().hi = chi;
+            }
+            insert(nodes[idx].children[c], rec, lo, hi, depth + 1);
+        }
+    }
+
+    static bool inside(const Node &node, const Vector3f &lo, const Vector3f &hi) {
+        return lo.x() >= node.lo.x() && lo.y() >= node.lo.y() && lo.z() >= node.lo.z() &&
+               hi.x() <= node.hi.x() && hi.y() <= node.hi.y() && hi.z() <= node.hi.z();
+    }
+
+    Real accuracy;
+    std::vector<Node> nodes;
+    std::vector<IrradianceRecord> records;
+    pthread_rwlock_t lock;
+};
+
+#endif // IRRADIANCE_CACHE_H
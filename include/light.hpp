@@ -2,26 +2,59 @@
 #define LIGHT_H
 
 #include <Vector3f.h>
+#include <algorithm>
+#include <cmath>
 #include "object3d.hpp"
 #include "photon.hpp"
 
-#define ran() ( double( rand() % RAND_MAX ) / RAND_MAX )
-
 class Light {
 public:
     Light() = default;
 
     virtual ~Light() = default;
 
-    virtual Photon EmitPhoton() const = 0;
-    virtual bool isHit(const Vector3f &o, const Vector3f &V) const = 0;
+    // Photon for the point (u, v) of the light's emission domain [0, 1)^2,
+    // which projection maps subdivide into cells; (s, t) picks the position
+    // on area lights. Uniform u, v, s and t give the light's own emission
+    // distribution.
+    virtual Photon EmitPhoton(Real u, Real v, Real s, Real t) const = 0;
+
+    // Whether the ray o + tV hits the emitting surface, with t its distance.
+    virtual bool isHit(const Vector3f & /*o*/, const Vector3f & /*V*/, Real & /*t*/) const {
+        return false;
+    }
+
+    // Direct light at x from the point (s, t) of the light. Sets wi, the unit
+    // direction from x to the light, and dist, the distance to it, and
+    // returns the flux density across wi in photon map units (4 pi times the
+    // irradiance on a surface facing wi). Zero if x gets no light from there.
+    virtual Vector3f sampleDirect(const Vector3f & /*x*/, Real /*s*/, Real /*t*/, Vector3f & /*wi*/, Real & /*dist*/) const {
+        return Vector3f(0);
+    }
 
-    double getColorPower() const{
+    // Whether sampleDirect gives this light's direct light. Photons from
+    // other lights are stored on their first hit even with directLighting.
+    virtual bool canSampleDirect() const {
+        return false;
+    }
+
+    // Bounding box of the emitting surface; false if the light cannot be hit.
+    virtual bool getBounds(Vector3f & /*lo*/, Vector3f & /*hi*/) const {
+        return false;
+    }
+
+    Real getColorPower() const{
         return (color.x()+color.y()+color.z())/3;
     }
 
     Vector3f color;
 
+protected:
+    // Equal-area map from [0, 1)^2 to the unit sphere.
+    static Vector3f sphereDirection(Real u, Real v) {
+        Real z = 1 - 2 * u, r = std::sqrt(std::max(Real(0), 1 - z * z)), phi = 2 * M_PI * v;
+        return Vector3f(r * std::cos(phi), r * std::sin(phi), z);
+    }
 };
 
 
@@ -39,18 +72,13 @@ public:
     ///@param p unsed in this function
     ///@param distanceToLight not well defined because it's not a point light
 
-    Photon EmitPhoton() const {
+    Photon EmitPhoton(Real /*u*/, Real /*v*/, Real /*s*/, Real /*t*/) const override {
         Vector3f power = color / getColorPower();
 	    Vector3f pos = Vector3f(0);
 	    Vector3f dir = direction;
 	    return Photon(power, pos, dir);
     }
 
-    bool isHit(const Vector3f &o, const Vector3f &V) const override {
-        return false;
-    }
-    
-
 private:
 
     Vector3f direction;
@@ -68,15 +96,22 @@ public:
 
     ~PointLight() override = default;
 
-    Photon EmitPhoton() const{
+    Photon EmitPhoton(Real u, Real v, Real /*s*/, Real /*t*/) const override {
         Vector3f power = color / getColorPower();
 	    Vector3f pos = position;
-	    Vector3f dir = Vector3f(2*ran()-1, 2*ran()-1, 2*ran()-1).normalized();
+	    Vector3f dir = sphereDirection(u, v);
 	    return Photon(power, pos, dir);
     }
 
-    bool isHit(const Vector3f &o, const Vector3f &V) const override {
-        return false;
+    Vector3f sampleDirect(const Vector3f &x, Real /*s*/, Real /*t*/, Vector3f &wi, Real &dist) const override {
+        wi = position - x;
+        dist = wi.length();
+        wi = wi / dist;
+        return color / (dist * dist);
+    }
+
+    bool canSampleDirect() const override {
+        return true;
     }
 
 private:
@@ -85,94 +120,111 @@ private:
 
 };
 
-class AreaLight : public Light {
+// Parallelogram light centred at position with half edges dirX and dirY.
+// Its plane and the dual edge vectors are computed once in setFrame, so a
+// hit test is a plane intersection and two dot products.
+class QuadLight : public Light {
+public:
+    bool isHit(const Vector3f &o, const Vector3f &V, Real &t) const override {
+        Real denominator = Vector3f::dot(normal, V);
+        Real EPS = 1e-7;
+        if (denominator < EPS/10 && denominator > -EPS/10) return false;
+        Real tTmp = (planeD - Vector3f::dot(normal, o)) / denominator;
+        if (tTmp <= EPS) return false;
+        Vector3f d = o + tTmp*V - position;
+        Real u = Vector3f::dot(d, dualX), v = Vector3f::dot(d, dualY);
+        if (u <= -1 || u >= 1 || v <= -1 || v >= 1) return false;
+        t = tTmp;
+        return true;
+    }
+
+    bool getBounds(Vector3f &lo, Vector3f &hi) const override {
+        for (int a = 0; a < 3; ++a) {
+            Real r = std::fabs(dirX[a]) + std::fabs(dirY[a]);
+            lo[a] = position[a] - r, hi[a] = position[a] + r;
+        }
+        return true;
+    }
+
+protected:
+    void setFrame() {
+        normal = Vector3f::cross(dirX, dirY).normalized();
+        planeD = Vector3f::dot(normal, position);
+        Vector3f px = Vector3f::cross(dirY, normal), py = Vector3f::cross(normal, dirX);
+        dualX = px / Vector3f::dot(dirX, px);
+        dualY = py / Vector3f::dot(dirY, py);
+    }
+
+    Vector3f position;
+    Vector3f dirX, dirY;
+    Vector3f normal, dualX, dualY;
+    Real planeD;
+};
+
+class AreaLight : public QuadLight {
 public:
 	AreaLight(const Vector3f &p, const Vector3f &c, const Vector3f &dx, const Vector3f &dy) {
         position = p;
         color = c;
         dirX = dx, dirY = dy;
+        setFrame();
     }
 	~AreaLight() {}
 
-    bool isHit(const Vector3f &o, const Vector3f &V) const override {
-        Vector3f normal = Vector3f::cross(dirX, dirY).normalized();
-        //if (Vector3f::dot(V, norm) == 0)   return false;
-        double denominator = Vector3f::dot(normal, V);
-        double EPS = 1e-7;
-        if (denominator >= EPS/10 || denominator <= -EPS/10 ){
-            double dividend = Vector3f::dot(normal, position) -Vector3f::dot(normal, o), tTmp = dividend/denominator;
-            if (tTmp > EPS){		
-                Vector3f hitPoint = o + tTmp*V;
-				Vector3f l1(position + dirX + dirY - hitPoint), l2(position + dirX - dirY - hitPoint), l3(position - dirX - dirY - hitPoint), l4(position - dirX + dirY - hitPoint);
-				Vector3f h1 = Vector3f::cross(l1,l2).normalized(), h2 = Vector3f::cross(l2,l3).normalized(), h3 = Vector3f::cross(l3,l4).normalized(), h4 = Vector3f::cross(l4,l1).normalized();
-				double tmp[4] = {Vector3f::dot(h1,h2), Vector3f::dot(h2,h3), Vector3f::dot(h3,h4), Vector3f::dot(h4,h1)};
-				if (tmp[0] > EPS && tmp[1] > EPS && tmp[2] > EPS && tmp[3] > EPS){
-                    return tTmp;
-				}
-			}
-		}
-        return 0;
-    }
-
-	Photon EmitPhoton() const override{
-        double x = 0, y = 0, z = 0;
+	// (u, v) picks the direction and (s, t) the position
+	Photon EmitPhoton(Real u, Real v, Real s, Real t) const override{
         Vector3f power = color / getColorPower();
-	    Vector3f pos = position + dirX * ( ran() * 2 - 1 ) + dirY * ( ran() * 2 - 1 );
-	    while ( x * x + y * y + z * z > 1 || x * x + y * y + z * z < 1e-7 )
-            x = 2 * ran() - 1, y = 2 * ran() - 1, z = 2 * ran() - 1;
-        Vector3f dir = Vector3f(x,y,z).normalized();
+	    Vector3f pos = position + dirX * ( s * 2 - 1 ) + dirY * ( t * 2 - 1 );
+        Vector3f dir = sphereDirection(u, v);
 	    return Photon(power, pos, dir);
     }
 
-private:
-    Vector3f position;
-    Vector3f dirX, dirY;
+    // every point of the light radiates evenly in all directions
+    Vector3f sampleDirect(const Vector3f &x, Real s, Real t, Vector3f &wi, Real &dist) const override {
+        wi = position + dirX * ( s * 2 - 1 ) + dirY * ( t * 2 - 1 ) - x;
+        dist = wi.length();
+        wi = wi / dist;
+        return color / (dist * dist);
+    }
+
+    bool canSampleDirect() const override {
+        return true;
+    }
 };
 
-class RecLight : public Light {
+class RecLight : public QuadLight {
 public:
-	RecLight(const Vector3f &p, const Vector3f &d, const Vector3f &c, const Vector3f &up, double dx, double dy) {
+	RecLight(const Vector3f &p, const Vector3f &d, const Vector3f &c, const Vector3f &up, Real dx, Real dy) {
         position = p;
         direction = d.normalized();
         color = c;
         Vector3f tmpX = Vector3f::cross(up, direction).normalized(), tmpY = Vector3f::cross(tmpX, direction).normalized(); 
         dirX = dx*tmpX, dirY = dy*tmpY;
+        setFrame();
     }
 	~RecLight() {}
 
-    bool isHit(const Vector3f &o, const Vector3f &V) const override {
-        Vector3f normal = Vector3f::cross(dirX, dirY).normalized();
-        //if (Vector3f::dot(V, norm) == 0)   return false;
-        double denominator = Vector3f::dot(normal, V);
-        double EPS = 1e-7;
-        if (denominator >= EPS/10 || denominator <= -EPS/10 ){
-			//printf("Hit!!\n");
-            double dividend = Vector3f::dot(normal, position) -Vector3f::dot(normal, o), tTmp = dividend/denominator;
-            if (tTmp > EPS){		
-                Vector3f hitPoint = o + tTmp*V;
-				Vector3f l1(position + dirX + dirY - hitPoint), l2(position + dirX - dirY - hitPoint), l3(position - dirX - dirY - hitPoint), l4(position - dirX + dirY - hitPoint);
-				Vector3f h1 = Vector3f::cross(l1,l2).normalized(), h2 = Vector3f::cross(l2,l3).normalized(), h3 = Vector3f::cross(l3,l4).normalized(), h4 = Vector3f::cross(l4,l1).normalized();
-				double tmp[4] = {Vector3f::dot(h1,h2), Vector3f::dot(h2,h3), Vector3f::dot(h3,h4), Vector3f::dot(h4,h1)};
-				if (tmp[0] > EPS and tmp[1] > EPS and tmp[2] > EPS and tmp[3] > EPS){
-                    return tTmp;
-				}
-			}
-		}
-        return 0;
-    }
-
-	Photon EmitPhoton() const override{
-        double refrN = 1, x,y,z;
+	// (u, v) picks the position; all photons leave along the light direction
+	Photon EmitPhoton(Real u, Real v, Real /*s*/, Real /*t*/) const override{
         Vector3f power = color / getColorPower();
-	    Vector3f pos = position + dirX * ( ran() * 2 - 1 ) + dirY * ( ran() * 2 - 1 );
+	    Vector3f pos = position + dirX * ( u * 2 - 1 ) + dirY * ( v * 2 - 1 );
         Vector3f dir = direction;
 	    return Photon(power, pos, dir);
     }
 
+    // a parallel beam: x is lit only if it lies in it
+    Vector3f sampleDirect(const Vector3f &x, Real /*s*/, Real /*t*/, Vector3f &wi, Real &dist) const override {
+        wi = -direction;
+        if (!isHit(x, wi, dist)) return Vector3f(0);
+        return color * (4 * M_PI / (4 * dirX.length() * dirY.length()));
+    }
+
+    bool canSampleDirect() const override {
+        return true;
+    }
+
 private:
-    Vector3f position;
     Vector3f direction;
-    Vector3f dirX, dirY;
 };
 
 #endif // LIGHT_H
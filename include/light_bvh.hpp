@@ -0,0 +1,112 @@
+#ifndef LIGHT_BVH_H
+#define LIGHT_BVH_H
+
+#include <algorithm>
+#include <vector>
+#include <vecmath.h>
+
+#include "light.hpp"
+
+// Bounding volume hierarchy over the lights that can be seen by a ray
+// (those with getBounds), so finding the closest light along a ray costs
+// O(log n) box tests instead of a hit test against every light.
+class LightBVH {
+public:
+    void build(Light **lights, int n) {
+        items.clear(), nodes.clear();
+        for (int i = 0; i < n; ++i) {
+            Item item;
+            item.light = lights[i];
+            if (!lights[i]->getBounds(item.lo, item.hi)) continue;
+            // flat lights give boxes of zero thickness
+            item.lo -= Vector3f(1e-4), item.hi += Vector3f(1e-4);
+            item.centre = (item.lo + item.hi) / 2;
+            items.push_back(item);
+        }
+        if (items.empty()) return;
+        nodes.push_back(Node());
+        buildNode(0, 0, items.size());
+    }
+
+    // Closest light hit by o + tV, or NULL.
+    Light *intersect(const Vector3f &o, const Vector3f &V, Real &t) const {
+        Light *best = NULL;
+        if (nodes.empty()) return best;
+        Vector3f inv(1 / V.x(), 1 / V.y(), 1 / V.z());
+        int stack[64], top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const Node &node = nodes[stack[--top]];
+            if (!hitsBox(node, o, inv, best != NULL ? t : Real(1e38))) continue;
+            if (node.count > 0) {
+                for (int i = node.first; i < node.first + node.count; ++i) {
+                    Real ti;
+                    if (items[i].light->isHit(o, V, ti) && (best == NULL || ti < t))
+                        best = items[i].light, t = ti;
+                }
+            }
+            else {
+                stack[top++] = node.first;
+                stack[top++] = node.first + 1;
+            }
+        }
+        return best;
+    }
+
+private:
+    struct Item {
+        Light *light;
+        Vector3f lo, hi, centre;
+    };
+
+    // Leaves hold items [first, first + count); inner nodes have count 0 and
+    // their children at first and first + 1.
+    struct Node {
+        Vector3f lo, hi;
+        int first, count;
+    };
+
+    static const int LEAF_SIZE = 2;
+
+    void buildNode(int idx, int l, int r) {
+        Vector3f lo = items[l].lo, hi = items[l].hi, clo = items[l].centre, chi = items[l].centre;
+        for (int i = l + 1; i < r; ++i)
+            for (int a = 0; a < 3; ++a) {
+                lo[a] = std::min(lo[a], items[i].lo[a]), hi[a] = std::max(hi[a], items[i].hi[a]);
+                clo[a] = std::min(clo[a], items[i].centre[a]), chi[a] = std::max(chi[a], items[i].centre[a]);
+            }
+        nodes[idx].lo = lo, nodes[idx].hi = hi;
+        if (r - l <= LEAF_SIZE) {
+            nodes[idx].first = l, nodes[idx].count = r - l;
+            return;
+        }
+        // median split of the centres along their widest axis
+        int axis = 0;
+        for (int a = 1; a < 3; ++a)
+            if (chi[a] - clo[a] > chi[axis] - clo[axis]) axis = a;
+        int mid = (l + r) / 2;
+        std::nth_element(items.begin() + l, items.begin() + mid, items.begin() + r,
+            [axis](const Item &a, const Item &b) { return a.centre[axis] < b.centre[axis]; });
+        int left = nodes.size();
+        nodes.push_back(Node()), nodes.push_back(Node());
+        nodes[idx].first = left, nodes[idx].count = 0;
+        buildNode(left, l, mid);
+        buildNode(left + 1, mid, r);
+    }
+
+    static bool hitsBox(const Node &node, const Vector3f &o, const Vector3f &inv, Real tMax) {
+        Real t0 = 0, t1 = tMax;
+        for (int a = 0; a < 3; ++a) {
+            Real ta = (node.lo[a] - o[a]) * inv[a], tb = (node.hi[a] - o[a]) * inv[a];
+            if (ta > tb) std::swap(ta, tb);
+            t0 = std::max(t0, ta), t1 = std::min(t1, tb);
+            if (t0 > t1) return false;
+        }
+        return true;
+    }
+
+    std::vector<Item> items;
+    std::vector<Node> nodes;
+};
+
+#endif // LIGHT_BVH_H
@@ -0,0 +1,45 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Read-only memory mapping of a whole file. data() is NULL if the file could
+// not be opened or is empty.
+class MappedFile {
+public:
+    explicit MappedFile(const char *filename) : ptr(NULL), len(0) {
+        int fd = open(filename, O_RDONLY);
+        if (fd < 0) return;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void *p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                ptr = (const char *)p;
+                len = st.st_size;
+                madvise(p, len, MADV_SEQUENTIAL);
+            }
+        }
+        close(fd);
+    }
+
+    ~MappedFile() {
+        if (ptr != NULL)
+            munmap((void *)ptr, len);
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const char *data() const { return ptr; }
+    size_t size() const { return len; }
+
+private:
+    const char *ptr;
+    size_t len;
+};
+
+#endif // MAPPED_FILE_H
@@ -7,7 +7,8 @@
 #include "ray.hpp"
 #include "hit.hpp"
 #include <iostream>
-#include "image.hpp"
+#include <string>
+#include "texture.hpp"
 
 // TODO: Implement Shade function that computes Phong introduced in class.
 class Material {
@@ -25,46 +26,47 @@ public:
         tw=0, th=0;
     }
 
-    explicit Material(const Vector3f &mColor,const Vector3f &textDir=Vector3f::ZERO, const Vector3f &absorption = Vector3f::ZERO, double diffusion = 1, double shininess = 0, double reflection = 0, double refraction = 0, double refractionN = 1, char* fName = NULL, double tc = 1) :
+    explicit Material(const Vector3f &mColor,const Vector3f &textDir=Vector3f::ZERO, const Vector3f &absorption = Vector3f::ZERO, Real diffusion = 1, Real shininess = 0, Real reflection = 0, Real refraction = 0, Real refractionN = 1, char* fName = NULL, Real tc = 1) :
             mColor(mColor), absorption(absorption), diffusion(diffusion), shininess(shininess), reflection(reflection), refraction(refraction), refractionN(refractionN), textcoff(tc) {
         
-        if (*fName != 0){
-            texture = Image::LoadPPM(fName);
-            //std::cout << fName << "***"<<texture->Width()<<" "<<texture->Height()<<"\n";
+        // the texture itself is read by loadTexture()
+        texture = NULL;
+        tw = 0, th = 0;
+        if (fName != NULL && *fName != 0)
+            textureFile = fName;
+        this->textDirection = textDir;
+    }
+
+    // Called by the scene parser once all materials are known, so that
+    // several textures can be read at the same time.
+    void loadTexture() {
+        if (textureFile.empty() || texture != NULL)
+            return;
+        texture = Texture::Load(textureFile.c_str());
+        if (texture != NULL) {
             this->tw = texture->Width();
             this->th = texture->Height();
-            this->textDirection = textDir;
-            //printf("%d %d\n", this->tw, this->th);
-        }
-        else {
-            tw = 0;
-            th = 0;
-            texture = NULL;
         }
     }
     
-    double getColorPower() const{
+    Real getColorPower() const{
         return (mColor.x()+mColor.y()+mColor.z())/3;
     }
 
-    Vector3f getTextureColor(double u, double v){
-        int x = (int)(u*textcoff)%tw;
-        if (x<0) x += tw;
-        int y = (int)(v*textcoff)%th;
-        if (y<0) y += th;
-        Vector3f color = texture->GetPixel(x, y);
-        // color.print();
-        return color;
+    // footprint is the size of the shaded area in texture coordinate units
+    Vector3f getTextureColor(Real u, Real v, Real footprint = 0) const {
+        return texture->Sample(u*textcoff, v*textcoff, footprint*textcoff);
     }
 
     virtual ~Material() = default;
     
-    double diffusion, shininess, reflection, refraction, refractionN, textcoff;
+    Real diffusion, shininess, reflection, refraction, refractionN, textcoff;
     Vector3f mColor, absorption, textDirection;
-    Image *texture = NULL;
+    Texture *texture = NULL;
+    std::string textureFile;
     int tw=0, th=0;
 
-    // double clamp(double x) {
+    // Real clamp(Real x) {
     //     if (x < 0) return 0;
     //     return x;
     // }
@@ -78,7 +80,7 @@ public:
     //     Vector3f R = 2 * Vector3f::dot(N, L) * N - L;
     //     R = R.normalized();  // !!!!!!
 
-    //     Vector3f sum = diffuseColor * clamp(Vector3f::dot(L,N)) + specularColor * pow((double)clamp(Vector3f::dot(V,R)),(double)shininess);
+    //     Vector3f sum = diffuseColor * clamp(Vector3f::dot(L,N)) + specularColor * pow((Real)clamp(Vector3f::dot(V,R)),(Real)shininess);
     //     shaded = lightColor * sum;
 
     //     return shaded;
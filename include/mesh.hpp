@@ -8,6 +8,13 @@
 #include "Vector3f.h"
 #include <map>
 #include <algorithm>
+#include <cstdint>
+#include <string>
+
+// Bump when the kd-tree builder or the cache layout changes.
+#define TRI_TREE_VERSION 1
+// Bump when the baked irradiance layout changes.
+#define BAKED_IRRADIANCE_VERSION 2
 
 class BoundBox {
 public:
@@ -16,10 +23,10 @@ public:
 		minPos = Vector3f(INFINITY, INFINITY, INFINITY);
 		maxPos = Vector3f(-INFINITY, -INFINITY, -INFINITY);
 	}
-    double GetMin3(double x, double y, double z) {return std::min(x,std::min(y,z));}
-    double GetMax3(double x, double y, double z) {return std::max(x,std::max(y,z));}
+    Real GetMin3(Real x, Real y, Real z) {return std::min(x,std::min(y,z));}
+    Real GetMax3(Real x, Real y, Real z) {return std::max(x,std::max(y,z));}
 	void UpdateBox(Triangle* tri){
-        double mn, mx;
+        Real mn, mx;
 		for (int i = 0; i < 3; ++i) {
             mn = GetMin3(tri->vertices[0][i], tri->vertices[1][i], tri->vertices[2][i]);
             mx = GetMax3(tri->vertices[0][i], tri->vertices[1][i], tri->vertices[2][i]);
@@ -28,23 +35,23 @@ public:
 		}
 	}
 	bool InBox(Vector3f ori){
-        double EPS = 1e-7;
+        Real EPS = 1e-7;
 		for (int i = 0; i < 3; i++)
 			if ((ori[i] <= minPos[i] - EPS) || (ori[i] >= maxPos[i] + EPS))
 				return false;
 		return true;
 	}
-	double GetArea(){
-		double a = maxPos[0] - minPos[0];
-		double b = maxPos[1] - minPos[1];
-		double c = maxPos[2] - minPos[2];
+	Real GetArea(){
+		Real a = maxPos[0] - minPos[0];
+		Real b = maxPos[1] - minPos[1];
+		Real c = maxPos[2] - minPos[2];
 		return 2 * (a * b + b * c + c * a);
 	}
-    double intersect(const Ray &r) {
-		double minDist = -1;
+    Real intersect(const Ray &r) {
+		Real minDist = -1;
 		Vector3f ray_O = r.getOrigin(), ray_V = r.getDirection();
 		for (int i = 0; i < 3; i++) {
-			double tmpT = -1;
+			Real tmpT = -1;
 			if (ray_V[i] >= 1e-7)
 				tmpT = (minPos[i] - ray_O[i]) / ray_V[i];
 			else if (ray_V[i] <= -1e-7)
@@ -52,7 +59,7 @@ public:
 			if (tmpT >= 1e-7) {
 				Vector3f C = ray_O + ray_V * tmpT;
 				if (InBox(C)) {
-					double dist = (C - ray_O).length();
+					Real dist = (C - ray_O).length();
 					if (minDist <= -1e-7 || minDist > dist)
 						minDist = dist;
 				}
@@ -66,7 +73,7 @@ class TriTreeNode {
 public:
 	Triangle** triangleList;
 	int size, plane;
-	double split;
+	Real split;
 	BoundBox box;
 	TriTreeNode* ls;
 	TriTreeNode* rs;
@@ -75,6 +82,7 @@ public:
 		size = 0;
 		plane = -1;
 		split = 0;
+		triangleList = NULL;
 		ls = rs = NULL;
 	}
 	~TriTreeNode(){
@@ -97,7 +105,7 @@ class TriangleTree {
 	}
 	void sortList(Triangle** triangleList, int l, int r, int i, bool minCoord);
 	void build(TriTreeNode* node);
-	bool searchTree(TriTreeNode* node, const Ray &r, Hit &h, double tmin);
+	bool searchTree(TriTreeNode* node, const Ray &r, Hit &h, Real tmin);
 
 public:
 	TriTreeNode* root;
@@ -113,30 +121,63 @@ public:
 		root->box.maxPos.print();
     	root->box.minPos.print();
 	}
-	bool intersect(const Ray &r, Hit &h, double tmin){
+	bool intersect(const Ray &r, Hit &h, Real tmin){
 		return searchTree(root, r, h, tmin);
 	}
+	// Sidecar cache of the built tree, keyed by a hash of the mesh and build
+	// parameters. Triangles are referenced by their id in the mesh.
+	bool loadCache(const std::string &file, uint64_t hash, Triangle** triangles, int triCnt);
+	void saveCache(const std::string &file, uint64_t hash, int triCnt);
 };
 
 class Mesh : public Object3D {
 public:
-    Mesh(const char *filename, Material *m, double scale);
+    Mesh(const char *filename, Material *m, Real scale);
 
 	TriangleTree* tree;
-	double scale=0.3;
-    bool intersect(const Ray &r, Hit &h, double tmin) override;
-	void getSize(std::string file);
-	void getMtlSize(std::string file);
-	void getMtl(std::string file);
+	Real scale=0.3;
+    bool intersect(const Ray &r, Hit &h, Real tmin) override;
+	void parseMtl(const std::string &file);
+
+	void findMeshes(const Matrix4f &toWorld, std::vector<std::pair<Mesh*, Matrix4f> > &out) override {
+		out.push_back(std::make_pair(this, toWorld));
+	}
+
+	const std::string &getFile() const { return file; }
+	// scaled vertices and area-weighted vertex normals, 0-based
+	const std::vector<Vector3f> &getVertices() const { return vertices; }
+	const std::vector<Vector3f> &getVertexNormals() const { return vertexNormals; }
+	const std::vector<Triangle*> &getTriangles() const { return triangleList; }
+
+	// Irradiance baked at the vertices (see PhotonMapping::bakeMesh), two
+	// values per vertex: on the side its normal points to and on the other.
+	// Hits on the mesh then carry the interpolated value. The sidecar file
+	// is keyed by the mesh, the placement of this instance in the world and
+	// lighting, a hash of the scene and the settings the light depends on.
+	void setBaked(const std::vector<Vector3f> &irradiance);
+	bool loadBaked(const Matrix4f &toWorld, uint64_t lighting);
+	void saveBaked(const Matrix4f &toWorld, uint64_t lighting) const;
+	std::string bakedFile(const Matrix4f &toWorld, uint64_t lighting) const;
+
+	// Simplified copy of a purely diffuse mesh with at most target
+	// triangles (see simplifyMesh), intersected instead of the full mesh
+	// while setProxy(true). Photons are traced against it: they only land
+	// on such a mesh, so its fine detail does not show in their
+	// distribution. Meshes that reflect or refract keep the full mesh.
+	void buildProxy(int target);
+	void setProxy(bool on) { proxyActive = on && proxyTree != NULL; }
 
 private:
-	int vSize, vtSize, vnSize, fSize, matSize;
-	Vector3f* v;
-	std::pair<double, double>* vt;
-	Vector3f* vn;
-	Triangle** triangleList;
-	Material** mat;
+	std::string file;
+	uint64_t hash;
+	std::vector<Triangle*> triangleList;
+	std::vector<Material*> mat;
 	std::map<std::string, int> matMap;	
+	std::vector<Vector3f> vertices, vertexNormals;
+	std::vector<Vector3f> baked;
+	TriangleTree* proxyTree = NULL;
+	std::vector<Triangle*> proxyList;
+	bool proxyActive = false;
     
     // Normal can be used for light estimation
     void computeNormal();
@@ -0,0 +1,70 @@
+#ifndef MESH_IO_H
+#define MESH_IO_H
+
+#include <vecmath.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// One triangle of the index buffer: 1-based vertex indices (-1 if absent)
+// and an index into MeshData::mtlNames (-1 for the scene material).
+struct MeshFace {
+	int v[3], vt[3], vn[3];
+	int mtl;
+};
+
+// Geometry of a mesh file before it is turned into triangles. Index 0 of the
+// vertex arrays is unused so OBJ indices can be used directly.
+struct MeshData {
+	std::vector<Vector3f> v, vn;
+	std::vector<std::pair<Real, Real> > vt;
+	std::vector<MeshFace> faces;
+	std::vector<std::string> mtllibs, mtlNames;
+};
+
+// Text OBJ, parsed in one pass (in parallel chunks for large files).
+void parseObj(const char *data, size_t size, MeshData &mesh);
+
+// Binary mesh: header | vertices (float or 16-bit quantized) | OBJ vertex
+// indices of the faces | face material ids | string table (mtllib files,
+// then material names). Texture and normal indices are not stored.
+#define BINARY_MESH_VERSION 1
+#define BINARY_MESH_QUANTIZED 1
+
+struct BinaryMeshHeader {
+	char magic[4];
+	uint32_t version, flags;
+	uint32_t vertexCnt, faceCnt;
+	uint32_t mtllibCnt, mtlNameCnt;
+	float boxMin[3], boxMax[3];
+	uint64_t vertexOffset, faceOffset, faceMtlOffset, stringOffset, fileSize;
+};
+
+bool isBinaryMesh(const char *data, size_t size);
+// Copies the mapped arrays into mesh. The format has no normals or texture
+// coordinates, so vn and vt hold only their unused entry 0 and every face
+// index into them is -1. On false, mesh is left as it was.
+bool loadBinaryMesh(const char *data, size_t size, MeshData &mesh);
+bool saveBinaryMesh(const char *filename, const MeshData &mesh, bool quantize);
+
+// Line scanning helpers shared with the MTL parser.
+inline bool isBlank(char c) {
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline void skipBlank(const char *&p, const char *end) {
+	while (p < end && isBlank(*p)) ++p;
+}
+
+inline bool isKeyword(const char *p, const char *end, const char *key, int len) {
+	return end - p > len && std::char_traits<char>::compare(p, key, len) == 0 && isBlank(p[len]);
+}
+
+const char *nextLine(const char *p, const char *end);
+bool parseInt(const char *&p, const char *end, int &out);
+bool parseReal(const char *&p, const char *end, Real &out);
+std::string parseWord(const char *&p, const char *end);
+
+#endif // MESH_IO_H
@@ -0,0 +1,17 @@
+#ifndef MESH_SIMPLIFY_H
+#define MESH_SIMPLIFY_H
+
+#include <vecmath.h>
+#include <vector>
+
+// Garland and Heckbert's quadric error simplification of an indexed triangle
+// mesh (three 0-based vertex indices per face). Edges are collapsed, cheapest
+// first, until at most target faces are left. The merged vertex is put at
+// whichever of the two ends or their midpoint has the least error, so the
+// result stays inside the bounding box of the input. Collapses that would
+// flip a face are skipped, and border edges are held in place by planes
+// perpendicular to their face. Each face left keeps in sources the index of
+// the input face it came from.
+void simplifyMesh(std::vector<Vector3f> &vertices, std::vector<int> &indices, std::vector<int> &sources, int target);
+
+#endif // MESH_SIMPLIFY_H
@@ -4,6 +4,10 @@
 #include "ray.hpp"
 #include "hit.hpp"
 #include "material.hpp"
+#include <utility>
+#include <vector>
+
+class Mesh;
 
 // Base class for all 3d entities.
 class Object3D {
@@ -17,9 +21,15 @@ public:
     }
 
     // Intersect Ray with this object. If hit, store information in hit structure.
-    virtual bool intersect(const Ray &r, Hit &h, double tmin) = 0;
-    double norm2(Vector3f v) {return v.x()*v.x() + v.y()*v.y() + v.z()*v.z();}
-    double norm(Vector3f v) {return sqrt(v.x()*v.x() + v.y()*v.y() + v.z()*v.z());}
+    virtual bool intersect(const Ray &r, Hit &h, Real tmin) = 0;
+    // Fill in normal, material and texture coordinates of a hit this object
+    // recorded. r is the ray in this object's space.
+    virtual void computeHit(const Ray &, Hit &) const {}
+    // Collect the meshes below this object with the matrix taking each to
+    // world space, for work done per mesh vertex (see irradiance baking).
+    virtual void findMeshes(const Matrix4f &, std::vector<std::pair<Mesh*, Matrix4f> > &) {}
+    Real norm2(Vector3f v) {return v.x()*v.x() + v.y()*v.y() + v.z()*v.z();}
+    Real norm(Vector3f v) {return sqrt(v.x()*v.x() + v.y()*v.y() + v.z()*v.z());}
     Material *material;
     
 protected:
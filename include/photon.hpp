@@ -7,7 +7,7 @@ struct Photon {
     Vector3f position;
     Vector3f direction;
     Vector3f absorb;
-    double currentN;
+    Real currentN;
     Photon() {
         ls = rs = d = 0;
         absorb = Vector3f(0);
@@ -2,18 +2,32 @@
 #define PHOTONMAPPING_H
 
 #include "scene_parser.hpp"
+#include "mesh.hpp"
 #include "photon.hpp"
+#include "progress.hpp"
+#include "light_bvh.hpp"
+#include "alias_table.hpp"
+#include "projection_map.hpp"
+#include "importance_map.hpp"
+#include "irradiance_cache.hpp"
+#include "sampler.hpp"
 #include <vecmath.h>
 #include <float.h>
 #include <cmath>
 #include <algorithm>
+#include <cstdint>
 #include <queue>
 #include <map>
+#include <vector>
 
-#define ran() ( double( rand() % RAND_MAX ) / RAND_MAX )
+#define ran() ( Real( rand() % RAND_MAX ) / RAND_MAX )
 #define MAX_TRACING_DEPTH 8 
 #define EPS 1e-7
 #define HITPOINTOUTER 0.1
+#define SHADOW_EPS 1e-3
+// bounds of the irradiance cache record spacing, in pixels
+#define MIN_RECORD_PIXELS 2
+#define MAX_RECORD_PIXELS 32
 
 
 struct PhotonBeenFound {
@@ -22,25 +36,28 @@ struct PhotonBeenFound {
     int foundNum;
 
 	bool heapDone;
-	double lim;
+	Real lim;
 	Photon** photons;
+    // (1 + epsilon)^2 for approximate searches
+    Real prune;
     
-    std::priority_queue<std::pair<double, Photon*>>* hp;
+    std::priority_queue<std::pair<Real, Photon*>>* hp;
 
-	PhotonBeenFound(Vector3f pos, int maxtf, double l){
+	PhotonBeenFound(Vector3f pos, int maxtf, Real l, Real epsilon = 0){
         position = pos, maxToFound = maxtf, lim = l;
+        prune = (1 + epsilon) * (1 + epsilon);
         foundNum = 0;
         heapDone = false;
         photons = new Photon*[maxtf + 1];
     }
 };
 
-Vector3f rotation(const Vector3f &target, const Vector3f &axis, double theta ) {
-	double resx, resy, resz;
-    double targetx = target.x(), targety = target.y(), targetz = target.z();
-    double axisx = axis.x(), axisy = axis.y(), axisz = axis.z(); 
-	double cost = cos( theta );
-	double sint = sin( theta );
+Vector3f rotation(const Vector3f &target, const Vector3f &axis, Real theta ) {
+	Real resx = 0, resy = 0, resz = 0;
+    Real targetx = target.x(), targety = target.y(), targetz = target.z();
+    Real axisx = axis.x(), axisy = axis.y(), axisz = axis.z(); 
+	Real cost = cos( theta );
+	Real sint = sin( theta );
 	resx += targetx * ( axisx * axisx + ( 1 - axisx * axisx ) * cost );
 	resx += targety * ( axisx * axisy * ( 1 - cost ) - axisz * sint );
 	resx += targetz * ( axisx * axisz * ( 1 - cost ) + axisy * sint );
@@ -53,6 +70,25 @@ Vector3f rotation(const Vector3f &target, const Vector3f &axis, double theta ) {
 	return Vector3f(resx, resy, resz);
 }
 
+// A ray waiting to be traced by backwardTracing, with the factor its
+// radiance is multiplied by before it reaches the pixel.
+struct PathVertex {
+    Vector3f origin, direction;
+    Vector3f throughput;
+    int depth;
+    Real currentN;
+    Vector3f absorb;
+};
+
+// Summary of the photons in a kd-tree subtree: their total power and
+// count, and bounding boxes of their positions and of their directions.
+struct PhotonAggregate {
+    Vector3f power;
+    int count;
+    Vector3f lo, hi;
+    Vector3f dirLo, dirHi;
+};
+
 // Construct KD-Tree
 int nowd;
 inline bool cmp(Photon a, Photon b) {
@@ -72,35 +108,41 @@ public:
         box_min = Vector3f(inf, inf, inf);
         box_max = Vector3f(-inf, -inf, -inf);
     }
+    // Once toFound photons are kept, the far side of a split is skipped
+    // unless it is closer than the farthest kept photon by a factor of
+    // 1 + epsilon, so every photon returned is within 1 + epsilon times the
+    // distance of the true k-th nearest.
     void findPhoton(PhotonBeenFound* np, int p) {
         Photon *curphoton = &photons[p];
-        nowd = curphoton->d;
-        double dist = np->position[nowd] - curphoton->position[nowd];
+        Real dist = np->position[curphoton->d] - curphoton->position[curphoton->d];
         if (dist >= 0) {
             if(curphoton->rs) findPhoton(np, curphoton->rs);
-            if (dist * dist < np->lim && curphoton->ls) 
+            if (dist * dist * (np->heapDone ? np->prune : 1) < np->lim && curphoton->ls) 
                 findPhoton(np, curphoton->ls);
         }
         else {
             if(curphoton->ls) findPhoton(np, curphoton->ls);
-            if (dist * dist < np->lim && curphoton->rs) 
+            if (dist * dist * (np->heapDone ? np->prune : 1) < np->lim && curphoton->rs) 
                 findPhoton(np, curphoton->rs);
         } 
 
-        double squareDis = (curphoton->position - np->position).squaredLength();
+        Real squareDis = (curphoton->position - np->position).squaredLength();
         if (squareDis > np->lim) return;
 
         if (np->foundNum < np->maxToFound)
             np->photons[++(np->foundNum)] = curphoton;
         else {
             if ( np->heapDone == false ) {
-                np->hp = new std::priority_queue<std::pair<double, Photon*>>;
+                np->hp = new std::priority_queue<std::pair<Real, Photon*>>;
                 for(int i = 1; i <= np->foundNum; ++i) 
-                    np->hp->push(std::make_pair(-(np->photons[i]->position - np->position).squaredLength(), np->photons[i]));
+                    np->hp->push(std::make_pair((np->photons[i]->position - np->position).squaredLength(), np->photons[i]));
                 np->heapDone = true;
             }
-            np->hp->push(std::make_pair(-squareDis, curphoton));
+            // keep the nearest maxToFound: drop the farthest, and search
+            // only within the farthest kept from now on
+            np->hp->push(std::make_pair(squareDis, curphoton));
             np->hp->pop();
+            np->lim = np->hp->top().first;
         }
     }
     void build(int &p, int l, int r) {
@@ -112,14 +154,15 @@ public:
         std::nth_element(photons+l, photons+mid, photons+r+1, cmp);
         p=mid; photons[p].d = nowd;
         if(l < mid) {
-            double rec = box_max[nowd];
+            Real rec = box_max[nowd];
             box_max[nowd] = photons[p].position[nowd];
             build(photons[p].ls, l, mid-1);
             box_max[photons[p].d] = rec;
         }
         if(r > mid) {
-            double rec = box_min[nowd];
-            box_min[nowd] = photons[p].position[nowd];
+            // the left subtree's build has changed nowd
+            Real rec = box_min[photons[p].d];
+            box_min[photons[p].d] = photons[p].position[photons[p].d];
             build(photons[p].rs, mid+1, r);
             box_min[photons[p].d] = rec;
         }
@@ -127,28 +170,128 @@ public:
     void buildKDTree() {
         build(rt, 1, stored_photons);
     }
+    // Subtree aggregates for getIrradiance; call after buildKDTree.
+    // tolerance bounds the size of subtrees taken or skipped whole at the
+    // edge of a gather, relative to its radius.
+    void buildAggregates(Real tolerance) {
+        aggregateTolerance = tolerance;
+        aggregates.assign(stored_photons + 1, PhotonAggregate());
+        if (stored_photons > 0) aggregate(rt);
+    }
+    void aggregate(int p) {
+        const Photon &photon = photons[p];
+        PhotonAggregate &a = aggregates[p];
+        a.power = photon.power, a.count = 1;
+        a.lo = a.hi = photon.position;
+        a.dirLo = a.dirHi = photon.direction;
+        for (int c : {photon.ls, photon.rs})
+            if (c) {
+                aggregate(c);
+                const PhotonAggregate &b = aggregates[c];
+                a.power += b.power, a.count += b.count;
+                for (int k = 0; k < 3; ++k) {
+                    a.lo[k] = std::min(a.lo[k], b.lo[k]), a.hi[k] = std::max(a.hi[k], b.hi[k]);
+                    a.dirLo[k] = std::min(a.dirLo[k], b.dirLo[k]), a.dirHi[k] = std::max(a.dirHi[k], b.dirHi[k]);
+                }
+            }
+    }
+    // Sums the photons within lim of x as getIrradiance counts them. A
+    // subtree whose directions all lie on one side of the surface is taken
+    // whole if its box is within lim, or if the box straddles lim but is
+    // no larger than aggregateTolerance * lim and its center is within lim;
+    // in the latter case it is skipped if the center is beyond lim. Only
+    // photons that close to the edge of the disc can be misclassified.
+    // Stops once more than maxCount photons are found.
+    void gatherAggregates(int p, const Vector3f &x, const Vector3f &normal, Real lim2, Real cell2,
+                          int maxCount, Vector3f &power, int &count) {
+        const PhotonAggregate &a = aggregates[p];
+        Real near2 = 0, far2 = 0;
+        for (int k = 0; k < 3; ++k) {
+            Real below = a.lo[k] - x[k], above = x[k] - a.hi[k];
+            Real d = std::max(Real(0), std::max(below, above));
+            Real f = std::max(std::fabs(below), std::fabs(above));
+            near2 += d * d, far2 += f * f;
+        }
+        if (near2 > lim2) return;
+        bool small = (a.hi - a.lo).squaredLength() <= cell2;
+        if (far2 <= lim2 || small) {
+            // range of normal . direction over the direction box
+            Real dotLo = 0, dotHi = 0;
+            for (int k = 0; k < 3; ++k) {
+                Real u = normal[k] * a.dirLo[k], v = normal[k] * a.dirHi[k];
+                dotLo += std::min(u, v), dotHi += std::max(u, v);
+            }
+            if (dotHi < 0 || dotLo >= 0) {
+                if (far2 > lim2 && ((a.lo + a.hi) / 2 - x).squaredLength() > lim2) return;
+                count += a.count;
+                if (dotHi < 0) power += a.power;
+                return;
+            }
+        }
+        const Photon &photon = photons[p];
+        if ((photon.position - x).squaredLength() <= lim2) {
+            count++;
+            if (Vector3f::dot(normal, photon.direction) < 0) power += photon.power;
+        }
+        if (photon.ls && count <= maxCount) gatherAggregates(photon.ls, x, normal, lim2, cell2, maxCount, power, count);
+        if (photon.rs && count <= maxCount) gatherAggregates(photon.rs, x, normal, lim2, cell2, maxCount, power, count);
+    }
+    // Called from the parallel emission loop. With an importance map,
+    // photons where no gather can find them are only kept with probability
+    // minStore, and carry the power of the ones dropped.
     void addPhoton(Photon photon) {
-        if(stored_photons+1 > maxInMap) return;
-        //printf("Done!");
-        //printf("%d %d Done!\n", stored_photons, maxInMap);
-        photons[++stored_photons] = photon;
-        box_min = Vector3f(std::min( box_min.x(), photon.position.x()), std::min( box_min.y(), photon.position.y()),
-                            std::min( box_min.z(), photon.position.z()));
-        box_max = Vector3f(std::max( box_max.x(), photon.position.x()), std::max( box_max.y(), photon.position.y()),
-                            std::max( box_max.z(), photon.position.z()));
-    }
-    Vector3f getIrradiance(Vector3f hitPoint, Vector3f hitNorm, double lim, int toFound) {
+        if (importance != NULL && !importance->visible(photon.position)) {
+            if (ran() >= minStore) return;
+            photon.power = photon.power / minStore;
+        }
+        #pragma omp critical (photonMap)
+        if(stored_photons+1 <= maxInMap) {
+            photons[++stored_photons] = photon;
+            box_min = Vector3f(std::min( box_min.x(), photon.position.x()), std::min( box_min.y(), photon.position.y()),
+                                std::min( box_min.z(), photon.position.z()));
+            box_max = Vector3f(std::max( box_max.x(), photon.position.x()), std::max( box_max.y(), photon.position.y()),
+                                std::max( box_max.z(), photon.position.z()));
+        }
+    }
+    // Position along a Z-order curve through the photon bounds, 10 bits per
+    // axis, so that queries sorted by it walk the kd-tree coherently.
+    uint32_t mortonCode(const Vector3f &p) const {
+        uint32_t code = 0;
+        for (int a = 0; a < 3; ++a) {
+            Real extent = box_max[a] - box_min[a];
+            Real f = extent > 0 ? (p[a] - box_min[a]) / extent : 0;
+            uint32_t q = (uint32_t)std::min(Real(1023), std::max(Real(0), f * 1024));
+            for (int b = 0; b < 10; ++b)
+                code |= ((q >> b) & 1) << (3 * b + a);
+        }
+        return code;
+    }
+    Vector3f getIrradiance(Vector3f hitPoint, Vector3f hitNorm, Real lim, int toFound) {
         // return Vector3f(0);
         Vector3f res(0);
-        PhotonBeenFound np(hitPoint, toFound, lim*lim);
+        if (!aggregates.empty()) {
+            // all photons in range are used as long as there are at most
+            // toFound of them, so they can be summed by subtree
+            int count = 0;
+            Real cell = aggregateTolerance * lim;
+            gatherAggregates(rt, hitPoint, hitNorm, lim * lim, cell * cell, toFound, res, count);
+            if (count <= toFound)
+                return count <= 8 ? Vector3f(0) : res * (4 / (emitPhoton * lim * lim));
+            res = Vector3f(0);
+        }
+        PhotonBeenFound np(hitPoint, toFound, lim*lim, epsilon);
 
         findPhoton(&np, rt);
         if ( np.foundNum <= 8 ) return Vector3f(0); // threshold 8
         // printf("%d %d\n", np.foundNum, np.maxToFound);
+        // with more than toFound photons in range the estimate covers the
+        // disc out to the farthest photon kept, not the whole search radius
+        Real area = np.lim;
         if (np.heapDone) {
+            area = np.hp->top().first;
             // printf("!\n");
             while(!np.hp->empty()) {
-                auto q = np.hp->top(); np.hp->pop(); //printf("%.2lf ", -q.first);
+                auto q = np.hp->top(); np.hp->pop(); //printf("%.2lf ", q.first);
                 if ( Vector3f::dot(hitNorm, q.second->direction) < 0 )
                     res += q.second->power;
             }
@@ -158,7 +301,7 @@ public:
             for (int i = 1; i <= np.foundNum; i++ )
                 if ( Vector3f::dot(hitNorm, np.photons[i]->direction) < 0 ) res += np.photons[i]->power;
 
-        res *=  4 / (emitPhoton * np.lim);
+        res *=  4 / (emitPhoton * area);
         delete[] np.photons;
         return res;
     }
@@ -175,6 +318,13 @@ public:
     Photon* photons;
     Vector3f box_max;
     Vector3f box_min;
+    const ImportanceMap *importance = NULL;
+    Real minStore = 1;
+    // k-nearest searches are (1 + epsilon)-approximate
+    Real epsilon = 0;
+    // empty unless buildAggregates was called
+    std::vector<PhotonAggregate> aggregates;
+    Real aggregateTolerance = 0;
 };
 
 class PhotonMapping {
@@ -182,25 +332,47 @@ public:
     SceneParser* sceneparser;
     Group* baseGroup;
     PhotonMap* map;
+    PhotonMap* causticMap = NULL;
+    // with finalGather, the first hits of photons from lights that cannot
+    // be sampled directly, for their direct light at camera hits
+    PhotonMap* unsampledMap = NULL;
+    ImportanceMap* importance = NULL;
+    IrradianceCache* irradianceCache = NULL;
+    std::vector<ProjectionMap> projectionMaps, causticProjectionMaps;
+    Progress* progress = NULL;
+    const RenderSettings* settings;
+    Sampler sampler;
+    AliasTable directLights;
+    Real pixelSpread;
+    LightBVH lightBVH;
 
     PhotonMapping(SceneParser* sceneparser) {
         this->sceneparser = sceneparser;
         this->baseGroup = sceneparser->getGroup();
+        this->pixelSpread = sceneparser->getCamera()->getPixelSpread();
+        this->settings = &sceneparser->getSettings();
+        this->sampler = Sampler(settings->sampler);
+        std::vector<Real> powers;
+        for (int li = 0; li < sceneparser->getNumLights(); ++li)
+            powers.push_back(sceneparser->getLight(li)->canSampleDirect() ? sceneparser->getLight(li)->getColorPower() : 0);
+        directLights = AliasTable(powers);
+        lightBVH.build(sceneparser->getLights(), sceneparser->getNumLights());
     }
 
     // -------------------Forward---------------------
 
-    void forwardDiffusion(Hit *hit, Photon photon){
+    // Cosine-weighted bounce; u and v pick the direction.
+    void forwardDiffusion(Hit *hit, Photon &photon, Real u, Real v){
         Material* material = hit->getMaterial();
         Vector3f hitNormed = hit->getNormal().normalized(), 
                  normVer = Vector3f::cross(hitNormed, Vector3f(1.1,0.2,0.23)).normalized();
-        double theta = acos( sqrt( ran() ) ), phi = ran() * 2 * M_PI; 
+        Real theta = acos( sqrt( u ) ), phi = v * 2 * M_PI; 
         
         photon.direction = rotation(rotation(hitNormed, normVer, theta), hitNormed, phi).normalized();
         photon.position += HITPOINTOUTER * photon.direction;
         photon.power = photon.power * material->mColor / material->getColorPower();
     }
-    void forwardReflection(Hit *hit , Photon photon){
+    void forwardReflection(Hit *hit , Photon &photon){
         Material* material = hit->getMaterial();
         Vector3f hitNormed = hit->getNormal().normalized();
 
@@ -208,16 +380,16 @@ public:
         photon.position += HITPOINTOUTER*photon.direction;
         photon.power = photon.power * material->mColor / hit->getMaterial()->getColorPower();
     }
-	void forwardRefraction(Hit *hit , Photon photon){
+	void forwardRefraction(Hit *hit , Photon &photon){
         Material* material = hit->getMaterial();
         Vector3f hitNormed = hit->getNormal().normalized(), nRayed = -photon.direction.normalized();
-        double tmpN;
+        Real tmpN;
         if (photon.currentN <= 1+EPS)
             tmpN = 1/material->refractionN;
         else
             tmpN = material->refractionN;
 
-        double nnt = tmpN, ddn = Vector3f::dot(-nRayed, hitNormed), cos2t=1-nnt*nnt*(1-ddn*ddn);
+        Real nnt = tmpN, ddn = Vector3f::dot(-nRayed, hitNormed), cos2t=1-nnt*nnt*(1-ddn*ddn);
 
         if (cos2t < EPS) {
             Vector3f reflDir = (2*Vector3f::dot(hitNormed, nRayed)*hitNormed - nRayed).normalized();
@@ -226,7 +398,7 @@ public:
             photon.position += HITPOINTOUTER*photon.direction;
         }
         else {
-            double cosI = -Vector3f::dot(hitNormed, photon.direction);
+            Real cosI = -Vector3f::dot(hitNormed, photon.direction);
 	        Vector3f refrDir =  photon.direction * nnt + hitNormed * ( nnt * cosI - sqrt( cos2t ) );
             refrDir = refrDir.normalized();
             if (photon.currentN <= 1+EPS) photon.currentN = material->refractionN;
@@ -236,7 +408,104 @@ public:
             photon.position += HITPOINTOUTER*photon.direction;
         }
     }
-    void forwardTracing(Photon photon, int depth) {
+    // Traces n importance particles from the camera through random pixels,
+    // following specular bounces like backwardTracing, and adds their
+    // throughput to the importance map at every diffuse hit.
+    void traceImportance(int n) {
+        Camera *camera = sceneparser->getCamera();
+        int W = camera->getWidth(), H = camera->getHeight();
+        #pragma omp parallel
+        {
+            ImportanceMap local(importance->getCellSize());
+            PathVertex stack[2 * MAX_TRACING_DEPTH + 2];
+            #pragma omp for schedule(dynamic, 1024)
+            for (int i = 0; i < n; ++i) {
+                Ray camRay = camera->generateRay(Vector2f(ran() * W - 0.5, ran() * H - 0.5));
+                int top = 0;
+                stack[top++] = PathVertex{camRay.getOrigin(), camRay.getDirection(), Vector3f(1), 1, 1, Vector3f(0)};
+                while (top > 0) {
+                    PathVertex v = stack[--top];
+                    Ray r(v.origin, v.direction);
+                    Hit hit;
+                    if (!baseGroup->intersect(r, hit, 0)) continue;
+                    evalHit(r, hit);
+                    if (hit.getMaterial()->diffusion > EPS)
+                        local.add(r.pointAtParameter(hit.getT()), maxComponent(v.throughput) * hit.getMaterial()->diffusion);
+                    top += spawnVertices(&hit, &r, v, stack + top);
+                }
+            }
+            #pragma omp critical
+            importance->merge(local);
+        }
+        importance->finish();
+    }
+
+    // Builds the projection maps used by emitPhotons: one per light over the
+    // scene, and one over reflective and refractive objects if there is a
+    // caustic map. Both are weighted by the importance map, if any.
+    void buildProjectionMaps(int res) {
+        for (int li = 0; li < sceneparser->getNumLights(); ++li) {
+            if (settings->projectionMaps || importance != NULL)
+                projectionMaps.push_back(ProjectionMap(sceneparser->getLight(li), baseGroup, res, PROJECT_GEOMETRY, importance));
+            if (causticMap != NULL)
+                causticProjectionMaps.push_back(ProjectionMap(sceneparser->getLight(li), baseGroup, res, PROJECT_CAUSTIC, importance));
+        }
+    }
+
+    // Emits n photons into map, or into causticMap if caustic is set. Each
+    // photon picks its light by power (times its projection map coverage,
+    // if any) from one parallel loop over all photons.
+    void emitPhotons(int n, bool caustic) {
+        int numLights = sceneparser->getNumLights();
+        const std::vector<ProjectionMap> &projection = caustic ? causticProjectionMaps : projectionMaps;
+        std::vector<Real> weights(numLights);
+        for (int li = 0; li < numLights; ++li) {
+            weights[li] = sceneparser->getLight(li)->getColorPower();
+            if (!projection.empty()) weights[li] *= projection[li].getCoverage();
+        }
+        AliasTable lights(weights);
+        Real power = lights.getTotal();
+        if (power <= 0) return;
+        std::vector<long> emitted(numLights, 0);
+        #pragma omp parallel
+        {
+            std::vector<long> localEmitted(numLights, 0);
+            #pragma omp for schedule(dynamic, 1024)
+            for (int i = 0; i < n; i ++){
+                // photon i is point i of the sequence; the two passes are
+                // scrambled differently
+                SampleStream stream(&sampler, i, caustic);
+                int li = lights.sample(stream.next(), stream.next());
+                Light *light = sceneparser->getLight(li);
+                Photon photon;
+                if (!projection.empty())
+                    photon = projection[li].emit(light, stream);
+                else {
+                    Real u = stream.next(), v = stream.next(), s = stream.next(), t = stream.next();
+                    photon = light->EmitPhoton(u, v, s, t);
+                }
+                photon.power *= power;
+                forwardTracing(photon, 1, stream, caustic, light->canSampleDirect());
+                localEmitted[li]++;
+                if (progress != NULL) progress->add(PROGRESS_PHOTONS);
+            }
+            #pragma omp critical
+            for (int li = 0; li < numLights; ++li)
+                emitted[li] += localEmitted[li];
+        }
+        if (!settings->quiet && numLights > 1)
+            for (int li = 0; li < numLights; ++li)
+                printf("light %d: %ld photons (expected %.0lf)\n", li, emitted[li], lights.pdf(li) * n);
+    }
+
+    // With caustic set only photons that reach a diffuse surface through
+    // specular bounces alone are traced and stored, in causticMap. Otherwise
+    // those photons are left out of map when there is a caustic map. The
+    // first hit is left out of map too with directLighting if the light is
+    // sampled at render time (directSampled), and also goes to unsampledMap
+    // if it is not.
+    void forwardTracing(Photon photon, int depth, SampleStream &stream, bool caustic = false, bool directSampled = false) {
+        bool specularOnly = true;
         for(int depth = 1; depth <= MAX_TRACING_DEPTH; ++depth) {
             
             Hit hit;
@@ -244,6 +513,7 @@ public:
 
             bool isIntersect = baseGroup->intersect(R, hit, 0);
             if (isIntersect) {
+                evalHit(R, hit);
                 
                 Vector3f hitNormed = hit.getNormal().normalized(),
                         hitPoint = R.pointAtParameter(hit.getT());
@@ -251,21 +521,36 @@ public:
                 
                 // Diffusion -> store the photon
                 Material* material = hit.getMaterial();
-                if (material->diffusion > EPS)
-                    map->addPhoton(photon);
+                if (material->diffusion > EPS) {
+                    bool causticPath = specularOnly && depth > 1;
+                    if (caustic) {
+                        if (causticPath) causticMap->addPhoton(photon);
+                    }
+                    else {
+                        if ((!causticPath || causticMap == NULL) && (depth > 1 || !directSampled || !settings->directLighting || settings->finalGather))
+                            map->addPhoton(photon);
+                        if (depth == 1 && !directSampled && unsampledMap != NULL)
+                            unsampledMap->addPhoton(photon);
+                    }
+                }
                 // Russian Roulette
-                double tmp = ran();
-                double P_diff = material->diffusion * material->getColorPower();
-                double P_refl = material->reflection * material->getColorPower();
+                Real tmp = stream.next();
+                Real P_diff = material->diffusion * material->getColorPower();
+                Real P_refl = material->reflection * material->getColorPower();
                 
-                if (tmp < P_diff) forwardDiffusion(&hit, photon);
+                if (tmp < P_diff) {
+                    if (caustic) break;
+                    specularOnly = false;
+                    Real u = stream.next(), v = stream.next();
+                    forwardDiffusion(&hit, photon, u, v);
+                }
                 else if(tmp < P_diff + P_refl) forwardReflection(&hit, photon);
                 else {   
-                    double P_refr = material->refraction;
+                    Real P_refr = material->refraction;
                     if ( photon.currentN != 1 ) {
                         Vector3f absor = photon.absorb*(-hit.getT()*photon.direction.length());
                         Vector3f trans = Vector3f(exp( absor.x() ), exp( absor.y()), exp( absor.z()));
-                        double tPower = (trans.x()+trans.y()+trans.z())/3;
+                        Real tPower = (trans.x()+trans.y()+trans.z())/3;
                         P_refr *= tPower;
                         photon.power = photon.power * trans / tPower;
                     }
@@ -279,35 +564,228 @@ public:
 
     // -------------------Backward--------------------
 
+    // Direct irradiance at x from directSamples light samples, each from a
+    // light that can be sampled directly, picked by power and tested with a
+    // shadow ray. Same units as PhotonMap::getIrradiance.
+    Vector3f directLight(const Vector3f &x, const Vector3f &normal) {
+        Vector3f res(0);
+        if (directLights.getTotal() <= 0) return res;
+        int samples = std::max(1, settings->directSamples);
+        for (int k = 0; k < samples; ++k) {
+            int li = directLights.sample(ran(), ran());
+            Vector3f wi;
+            Real dist;
+            Vector3f e = sceneparser->getLight(li)->sampleDirect(x, ran(), ran(), wi, dist);
+            Real cosX = Vector3f::dot(normal, wi);
+            if (cosX <= 0 || maxComponent(e) <= 0) continue;
+            if (progress != NULL) progress->add(PROGRESS_RAYS);
+            Hit occluder(dist - SHADOW_EPS, NULL, Vector3f(0));
+            if (baseGroup->intersect(Ray(x, wi), occluder, SHADOW_EPS)) continue;
+            res += e * cosX / directLights.pdf(li);
+        }
+        return res / samples;
+    }
+
     Vector3f backwardDiff( Hit *hit, Ray *r) {
         Vector3f color(0);
         if (hit->getMaterial()->texture == NULL)
             color = hit->getMaterial()->mColor;
-        else
-            color = hit->getMaterial()->getTextureColor(hit->getX(), hit->getY());
+        else {
+            // width of one pixel at the hit, stretched on surfaces seen at a grazing angle
+            Real cosV = std::fabs(Vector3f::dot(hit->getNormal().normalized(), r->getDirection().normalized()));
+            Real footprint = hit->getT() * pixelSpread / std::max(cosV, (Real)0.125);
+            color = hit->getMaterial()->getTextureColor(hit->getX(), hit->getY(), footprint);
+        }
         Vector3f res = color * sceneparser->getBackgroundColor() * hit->getMaterial()->diffusion;
-        res += color * map->getIrradiance(r->pointAtParameter(hit->getT()), hit->getNormal().normalized(), map->sample_dist, map->sample_photons ) * hit->getMaterial()->diffusion;
+        if (progress != NULL) progress->add(PROGRESS_GATHERS);
+        Vector3f x = r->pointAtParameter(hit->getT()), normal = hit->getNormal().normalized();
+        Vector3f irradiance(0);
+        // the side of the surface the ray arrived from
+        if (settings->finalGather && Vector3f::dot(normal, r->getDirection()) > 0) normal = -normal;
+        if (hit->hasBakedIrradiance())
+            irradiance = hit->getBakedIrradiance();
+        else {
+            if (settings->finalGather)
+                irradiance = indirectIrradiance(x, normal, hit->getT() * pixelSpread);
+            else
+                irradiance = map->getIrradiance(x, normal, map->sample_dist, map->sample_photons );
+            if (causticMap != NULL)
+                irradiance += causticMap->getIrradiance(x, normal, causticMap->sample_dist, causticMap->sample_photons );
+        }
+        if (settings->directLighting || settings->finalGather)
+            irradiance += directLight(x, normal);
+        if (unsampledMap != NULL)
+            irradiance += unsampledMap->getIrradiance(x, normal, unsampledMap->sample_dist, unsampledMap->sample_photons);
+        res += color * irradiance * hit->getMaterial()->diffusion;
         return res;
     }
     
-    Vector3f backwardRefl( Hit *hit, Ray *r, int depth) {
+    // Irradiance at both sides of every vertex of a mesh placed in the world
+    // by toWorld, as backwardDiff gathers it without direct light: from a
+    // final gather (uncached) if finalGather is set, else from the photon
+    // map, plus caustics. Vertices are independent and baked in parallel.
+    std::vector<Vector3f> bakeMesh(const Mesh *mesh, const Matrix4f &toWorld) {
+        const std::vector<Vector3f> &vertices = mesh->getVertices(), &normals = mesh->getVertexNormals();
+        Matrix4f normalMatrix = toWorld.inverse().transposed();
+        std::vector<Vector3f> res(2 * vertices.size(), Vector3f(0));
+        #pragma omp parallel for schedule(dynamic, 16)
+        for (int i = 0; i < (int)vertices.size(); ++i) {
+            if (progress != NULL) progress->add(PROGRESS_GATHERS);
+            if (normals[i].length() == 0) continue;
+            Vector3f x = transformPoint(toWorld, vertices[i]);
+            Vector3f n = transformDirection(normalMatrix, normals[i]).normalized();
+            for (int side = 0; side < 2; ++side) {
+                Vector3f normal = side == 0 ? n : -n;
+                Vector3f e = settings->finalGather ? finalGather(x, normal).irradiance
+                                                   : map->getIrradiance(x, normal, map->sample_dist, map->sample_photons);
+                if (causticMap != NULL)
+                    e += causticMap->getIrradiance(x, normal, causticMap->sample_dist, causticMap->sample_photons);
+                res[2 * i + side] = e;
+            }
+        }
+        return res;
+    }
+
+    // Indirect irradiance at x from the irradiance cache, or from a new final
+    // gather that is then cached. footprint is the width of a pixel at x and
+    // bounds the spacing of cache records.
+    Vector3f indirectIrradiance(const Vector3f &x, const Vector3f &normal, Real footprint) {
+        Vector3f res;
+        if (irradianceCache != NULL && irradianceCache->lookup(x, normal, res))
+            return res;
+        IrradianceRecord rec = finalGather(x, normal);
+        if (irradianceCache != NULL) {
+            Real a = settings->cacheAccuracy;
+            rec.radius = std::min(std::max(rec.radius, MIN_RECORD_PIXELS * footprint / a), MAX_RECORD_PIXELS * footprint / a);
+            irradianceCache->insert(rec);
+        }
+        return rec.irradiance;
+    }
+
+    // Ward and Heckbert's final gather: M x N rays stratified in cos^2 theta
+    // and phi, so every ray carries the same cosine-weighted solid angle and
+    // the irradiance is the mean photon map radiance seen by the rays (see
+    // gatherRadiance). Differences between neighbouring strata give the
+    // rotational and translational gradients of the irradiance.
+    IrradianceRecord finalGather(const Vector3f &x, const Vector3f &normal) {
+        int M = std::max(1, (int)std::lround(std::sqrt(settings->gatherRays / M_PI)));
+        int N = std::max(1, (int)std::lround((Real)settings->gatherRays / M));
+        Vector3f u = Vector3f::cross(normal, std::fabs(normal.x()) > 0.5 ? Vector3f(0, 1, 0) : Vector3f(1, 0, 0)).normalized();
+        Vector3f v = Vector3f::cross(normal, u);
+        std::vector<Vector3f> L(M * N);
+        std::vector<Real> dist(M * N);
+        IrradianceRecord rec;
+        rec.position = x, rec.normal = normal;
+        rec.irradiance = Vector3f(0);
+        Real invDist = 0;
+        for (int j = 0; j < M; ++j)
+            for (int k = 0; k < N; ++k) {
+                Real sinTheta = std::sqrt((j + ran()) / M), phi = 2 * M_PI * (k + ran()) / N;
+                Vector3f dir = (std::cos(phi) * sinTheta * u + std::sin(phi) * sinTheta * v +
+                                std::sqrt(std::max(Real(0), 1 - sinTheta * sinTheta)) * normal).normalized();
+                Real t;
+                L[j * N + k] = gatherRadiance(Ray(x, dir), t);
+                dist[j * N + k] = t;
+                rec.irradiance += L[j * N + k];
+                invDist += 1 / t;
+            }
+        rec.irradiance = rec.irradiance / (M * N);
+        rec.radius = invDist > 0 ? M * N / invDist : FLT_MAX;
+
+        for (int c = 0; c < 3; ++c)
+            rec.rotGrad[c] = rec.transGrad[c] = Vector3f(0);
+        for (int k = 0; k < N; ++k) {
+            Real phiK = 2 * M_PI * (k + 0.5) / N, phiMinus = 2 * M_PI * k / N;
+            Vector3f uK = std::cos(phiK) * u + std::sin(phiK) * v;
+            Vector3f vK = -std::sin(phiK) * u + std::cos(phiK) * v;
+            Vector3f vMinus = -std::sin(phiMinus) * u + std::cos(phiMinus) * v;
+            Vector3f rot(0), alongU(0), alongV(0);
+            int prevK = (k + N - 1) % N;
+            for (int j = 0; j < M; ++j) {
+                Real sinLo = std::sqrt((Real)j / M), sinHi = std::sqrt((Real)(j + 1) / M);
+                Real sinMid = std::sqrt((j + 0.5) / M), cosMid = std::sqrt(1 - sinMid * sinMid);
+                rot += sinMid / cosMid * L[j * N + k];
+                if (j > 0) {
+                    Real cos2Lo = 1 - sinLo * sinLo;
+                    alongU += sinLo * cos2Lo / std::min(dist[j * N + k], dist[(j - 1) * N + k]) *
+                              (L[j * N + k] - L[(j - 1) * N + k]);
+                }
+                alongV += cosMid * (sinHi - sinLo) / std::min(dist[j * N + k], dist[j * N + prevK]) *
+                          (L[j * N + k] - L[j * N + prevK]);
+            }
+            for (int c = 0; c < 3; ++c) {
+                rec.rotGrad[c] += rot[c] / (M * N) * vK;
+                // Ward's gradient of pi times the mean radiance
+                rec.transGrad[c] += (alongU[c] * Real(2 * M_PI / N) * uK + alongV[c] * vMinus) / M_PI;
+            }
+        }
+        return rec;
+    }
+
+    // Photon map radiance reaching x along a gather ray, in the units of the
+    // irradiance (color * diffusion * irradiance at the diffuse surfaces it
+    // finds, following specular bounces like backwardTracing), and the
+    // distance t of its first hit.
+    Vector3f gatherRadiance(const Ray &ray, Real &t) {
+        PathVertex stack[2 * MAX_TRACING_DEPTH + 2];
+        int top = 0;
+        stack[top++] = PathVertex{ray.getOrigin(), ray.getDirection(), Vector3f(1), 1, 1, Vector3f(0)};
+        Vector3f res(0);
+        t = FLT_MAX;
+        while (top > 0) {
+            PathVertex v = stack[--top];
+            Ray r(v.origin, v.direction);
+            if (progress != NULL) progress->add(PROGRESS_RAYS);
+            Hit hit;
+            if (!baseGroup->intersect(r, hit, v.depth == 1 ? SHADOW_EPS : 0)) continue;
+            if (v.depth == 1) t = hit.getT();
+            evalHit(r, hit);
+            Material *m = hit.getMaterial();
+            if (m->diffusion > EPS) {
+                Vector3f y = r.pointAtParameter(hit.getT()), n = hit.getNormal().normalized();
+                Vector3f color = m->texture == NULL ? m->mColor : m->getTextureColor(hit.getX(), hit.getY(), 0);
+                Vector3f irradiance(0);
+                if (hit.hasBakedIrradiance())
+                    irradiance = hit.getBakedIrradiance();
+                else {
+                    irradiance = map->getIrradiance(y, n, map->sample_dist, map->sample_photons);
+                    if (causticMap != NULL)
+                        irradiance += causticMap->getIrradiance(y, n, causticMap->sample_dist, causticMap->sample_photons);
+                }
+                res += v.throughput * color * irradiance * m->diffusion;
+            }
+            top += spawnVertices(&hit, &r, v, stack + top);
+        }
+        return res;
+    }
+
+    // Reflected continuation of a path at a hit, weighted by the mirror color.
+    // Like the recursive tracer it replaced, it starts over in air (index 1,
+    // no absorption) even when the reflection is inside a refracting object.
+    PathVertex reflectedVertex( Hit *hit, Ray *r, const PathVertex &v) {
         Vector3f hitNormed = hit->getNormal().normalized(), nRayed = -r->getDirection().normalized();
         Vector3f reflDir = (2*Vector3f::dot(hitNormed, nRayed)*hitNormed - nRayed).normalized();
-        return backwardTracing(Ray(r->pointAtParameter(hit->getT())+HITPOINTOUTER*reflDir, reflDir), depth + 1) * hit->getMaterial()->mColor * hit->getMaterial()->reflection;
+        return PathVertex{r->pointAtParameter(hit->getT())+HITPOINTOUTER*reflDir, reflDir,
+                          v.throughput * hit->getMaterial()->mColor * hit->getMaterial()->reflection,
+                          v.depth + 1, 1, Vector3f(0)};
     }
 
-    Vector3f backwardRefr( Hit *hit, Ray *r, int depth, double cN = 1, Vector3f cAb = Vector3f(0)) {
+    // Refracted continuation (or total internal reflection), weighted by the
+    // refraction coefficient and the absorption of the medium left behind.
+    PathVertex refractedVertex( Hit *hit, Ray *r, const PathVertex &v) {
+        Real cN = v.currentN;
+        Vector3f cAb = v.absorb;
         Vector3f hitPoint = r->pointAtParameter(hit->getT());
         Vector3f hitNormed = hit->getNormal().normalized(), nRayed = -r->getDirection().normalized();
-        double tmpN;
+        Real tmpN;
         if (cN <= 1+EPS)
             tmpN = 1/hit->getMaterial()->refractionN;
         else
             tmpN = hit->getMaterial()->refractionN;
 
         Vector3f dir(0), newAb=cAb;
-        double newN = cN;
-        double nnt = tmpN, ddn = Vector3f::dot(-nRayed, hitNormed), cos2t=1-nnt*nnt*(1-ddn*ddn);
+        Real newN = cN;
+        Real nnt = tmpN, ddn = Vector3f::dot(-nRayed, hitNormed), cos2t=1-nnt*nnt*(1-ddn*ddn);
 
         if (cos2t < EPS){
             Vector3f reflDir = (2*Vector3f::dot(hitNormed, nRayed)*hitNormed - nRayed).normalized();
@@ -316,7 +794,7 @@ public:
         }
 
         else{
-            double cosI = -Vector3f::dot(hitNormed, -nRayed);
+            Real cosI = -Vector3f::dot(hitNormed, -nRayed);
 	        Vector3f refrDir =  -nRayed * nnt + hitNormed * ( nnt * cosI - sqrt( cos2t ) );
             refrDir = refrDir.normalized();
             if (newN <= 1 + EPS)  newN = hit->getMaterial()->refractionN;
@@ -325,41 +803,101 @@ public:
             dir = refrDir;
             hitPoint += HITPOINTOUTER*refrDir;
         }
-        
-        Vector3f rcol = backwardTracing( Ray(hitPoint, dir), depth + 1, newN, newAb);
-        if ( cN <= 1+EPS )
-            return rcol * hit->getMaterial()->refraction;
-        Vector3f absor = cAb*(hit->getT()*-r->getDirection().length());
-        Vector3f trans = Vector3f( exp( absor.x() ) , exp( absor.y()) , exp( absor.z()));
-        return rcol * trans * hit->getMaterial()->refraction;
-    }
-
-    Vector3f backwardTracing(Ray R, int depth, double currentN = 1, Vector3f cAbsorb = Vector3f(0)){
-        if (depth > MAX_TRACING_DEPTH) return Vector3f(0);
-        Hit hit;
-        bool isIntersect = baseGroup->intersect(R, hit, 0);
-        double tmpT = 1e6;
-        int lIdx = -1;
-        for (int li = 0 ; li < sceneparser->getNumLights(); ++li) {
-            int temp = sceneparser->getLight(li)->isHit(R.getOrigin(),R.getDirection());
-            if (temp != 0 && temp < tmpT)
-                lIdx = li, tmpT = temp;
+
+        Vector3f weight = Vector3f(hit->getMaterial()->refraction);
+        if ( cN > 1+EPS ) {
+            Vector3f absor = cAb*(hit->getT()*-r->getDirection().length());
+            weight = Vector3f( exp( absor.x() ) , exp( absor.y()) , exp( absor.z())) * hit->getMaterial()->refraction;
         }
-        
+        return PathVertex{hitPoint, dir, v.throughput * weight, v.depth + 1, newN, newAb};
+    }
+
+    static Real maxComponent(const Vector3f &c) {
+        return std::max(c[0], std::max(c[1], c[2]));
+    }
+
+    // Whether a continuation is worth tracing: below pathThreshold it is
+    // dropped, or with Russian roulette it survives with a probability
+    // proportional to its throughput and is reweighted.
+    bool keepVertex(PathVertex &v) {
+        if (v.depth > MAX_TRACING_DEPTH) return false;
+        Real m = maxComponent(v.throughput);
+        if (settings->branchMode == BRANCH_ROULETTE && m < settings->rouletteThreshold) {
+            Real p = m / settings->rouletteThreshold;
+            if (ran() >= p) return false;
+            v.throughput = v.throughput / p;
+            return true;
+        }
+        return m >= settings->pathThreshold;
+    }
+
+    // Whether the ray sees a light before the surface it hit.
+    bool seesLight(const Ray &r, bool isIntersect, Hit &hit) {
+        Real t;
+        return lightBVH.intersect(r.getOrigin(), r.getDirection(), t) != NULL && (!isIntersect || hit.getT() > t);
+    }
+
+    // Writes the specular continuations of v at a hit to out and returns
+    // how many are worth tracing.
+    int spawnVertices( Hit *hit, Ray *r, const PathVertex &v, PathVertex out[2]) {
+        Material *material = hit->getMaterial();
+        bool refl = material->reflection > EPS, refr = material->refraction > EPS;
+        int n = 0;
+        if (settings->branchMode == BRANCH_SINGLE && refl && refr) {
+            // follow one of the two specular rays, chosen by its weight
+            PathVertex a = reflectedVertex(hit, r, v), b = refractedVertex(hit, r, v);
+            Real wa = maxComponent(a.throughput), wb = maxComponent(b.throughput);
+            if (wa + wb <= 0) return 0;
+            Real pa = wa / (wa + wb);
+            if (ran() < pa) a.throughput = a.throughput / pa, out[n] = a;
+            else b.throughput = b.throughput / (1 - pa), out[n] = b;
+            return keepVertex(out[n]) ? 1 : 0;
+        }
+        if ( refl ) {
+            out[n] = reflectedVertex(hit, r, v);
+            if (keepVertex(out[n])) n++;
+        }
+        if ( refr ) {
+            out[n] = refractedVertex(hit, r, v);
+            if (keepVertex(out[n])) n++;
+        }
+        return n;
+    }
+
+    // Traces a camera (depth 1) or secondary ray. Instead of recursing into
+    // every reflected and refracted ray, pending rays are kept on a stack
+    // with the throughput they contribute with, so dim branches can be cut.
+    Vector3f backwardTracing(Ray R, int depth, Real currentN = 1, Vector3f cAbsorb = Vector3f(0)){
+        PathVertex stack[2 * MAX_TRACING_DEPTH + 2];
+        int top = 0;
+        if (depth <= MAX_TRACING_DEPTH)
+            stack[top++] = PathVertex{R.getOrigin(), R.getDirection(), Vector3f(1), depth, currentN, cAbsorb};
+
         Vector3f res;
         if (depth == 1) res = sceneparser->getBackgroundColor();
         else res = Vector3f(0);
-        if ((lIdx != -1) && (!isIntersect || hit.getT() > tmpT))
-            res += Vector3f(1);
-        if ( isIntersect ) {
-            // printf("isIntersect\n");
-            if ( hit.getMaterial()->diffusion > EPS ) res += backwardDiff( &hit, &R);
-            if ( hit.getMaterial()->reflection > EPS ) res += backwardRefl( &hit, &R, depth);
-            if ( hit.getMaterial()->refraction > EPS ) res += backwardRefr( &hit, &R, depth, currentN, cAbsorb);
-        }
-        if ( depth == 1 ) res = Vector3f( std::min( res[0] , double(1.0) ) , std::min( res[1] , double(1.0)) , std::min( res[2] , double(1.0) ) );
+        while (top > 0) {
+            PathVertex v = stack[--top];
+            Ray r(v.origin, v.direction);
+            if (progress != NULL) progress->add(PROGRESS_RAYS);
+            Hit hit;
+            bool isIntersect = baseGroup->intersect(r, hit, 0);
+            if (isIntersect)
+                evalHit(r, hit);
+            if (seesLight(r, isIntersect, hit))
+                res += v.throughput;
+            if ( !isIntersect ) continue;
+
+            if ( hit.getMaterial()->diffusion > EPS ) res += v.throughput * backwardDiff( &hit, &r);
+            top += spawnVertices(&hit, &r, v, stack + top);
+        }
+        if ( depth == 1 ) res = clampColor(res);
         return res;        
     }
+
+    static Vector3f clampColor(const Vector3f &c) {
+        return Vector3f( std::min( c[0] , Real(1.0) ) , std::min( c[1] , Real(1.0)) , std::min( c[2] , Real(1.0) ) );
+    }
 };
 
 #endif //PHOTONMAPPING_H
@@ -15,34 +15,44 @@ public:
         
     }
 
-    Plane(const Vector3f &normal, double d, Material *m) : Object3D(m) {
+    Plane(const Vector3f &normal, Real d, Material *m) : Object3D(m) {
         this->d = -d;  // n dot x + d = 0
         n = normal;
+        // texture axes for the unflipped normal; flipping it only negates pX
+        unitN = n.normalized();
+        pX = Vector3f::cross(unitN, material->textDirection).normalized();
+        pY = Vector3f::cross(unitN, pX).normalized();
     }
 
     ~Plane() override = default;
 
-    bool intersect(const Ray &r, Hit &h, double tmin) override {
+    bool intersect(const Ray &r, Hit &h, Real tmin) override {
         if(abs(Vector3f::dot(n, r.getDirection().normalized())) < eps) return false;
-        double t = -(d + Vector3f::dot(n,r.getOrigin())) / Vector3f::dot(n, r.getDirection().normalized());
+        Real t = -(d + Vector3f::dot(n,r.getOrigin())) / Vector3f::dot(n, r.getDirection().normalized());
         if (t > h.getT() + eps || t < tmin - eps)
             return false;
-        Vector3f normal = n;
-        normal = normal.normalized();
-        if (Vector3f::dot(r.getDirection().normalized(), normal) > 0)
-            normal = -normal;
-        Vector3f p = r.pointAtParameter(t);
-        Vector3f pX = Vector3f::cross(normal, material->textDirection).normalized(), pY = Vector3f::cross(normal, pX).normalized();
-        double x = Vector3f::dot(p, pX);
-        double y = Vector3f::dot(p, pY);
-        h.set(t, material, normal, x, y);
-        // printf("!!!!!\n");
+        h.record(t, this);
         return true;
     }
 
+    void computeHit(const Ray &r, Hit &h) const override {
+        Vector3f normal = unitN;
+        Vector3f p = r.pointAtParameter(h.getT());
+        Real x = Vector3f::dot(p, pX);
+        Real y = Vector3f::dot(p, pY);
+        if (Vector3f::dot(r.getDirection(), normal) > 0)
+            normal = -normal, x = -x;
+        h.set(h.getT(), material, normal, x, y);
+    }
+
+    // n dot x + d = 0, n is not necessarily normalized
+    const Vector3f &getNormal() const { return n; }
+    Real getOffset() const { return d; }
+
 protected:
-    double d;
+    Real d;
     Vector3f n;
+    Vector3f unitN, pX, pY;
 };
 
 #endif //PLANE_H
@@ -0,0 +1,125 @@
+#ifndef PRIMITIVE_LIST_H
+#define PRIMITIVE_LIST_H
+
+#include "sphere.hpp"
+#include "plane.hpp"
+#include <vecmath.h>
+#include <cmath>
+#include <vector>
+
+// Analytic primitives of one type stored as structure of arrays, so a whole
+// list is tested in one loop without virtual calls. Candidate t values are
+// computed a block at a time into a small buffer (vectorizable), and only the
+// closest hit of the list is recorded into the Hit.
+#define PRIMITIVE_BLOCK 64
+
+class SphereList {
+public:
+    void add(const Sphere *s) {
+        const Vector3f &c = s->getCenter();
+        cx.push_back(c.x()), cy.push_back(c.y()), cz.push_back(c.z());
+        r2.push_back(s->getRadius() * s->getRadius());
+        prims.push_back(s);
+    }
+
+    void append(const SphereList &l) {
+        cx.insert(cx.end(), l.cx.begin(), l.cx.end());
+        cy.insert(cy.end(), l.cy.begin(), l.cy.end());
+        cz.insert(cz.end(), l.cz.begin(), l.cz.end());
+        r2.insert(r2.end(), l.r2.begin(), l.r2.end());
+        prims.insert(prims.end(), l.prims.begin(), l.prims.end());
+    }
+
+    int size() const { return cx.size(); }
+
+    bool intersect(const Ray &r, Hit &h, Real tmin) const {
+        int n = size();
+        if (n == 0) return false;
+        Vector3f dir = r.getDirection().normalized();
+        const Real ox = r.getOrigin().x(), oy = r.getOrigin().y(), oz = r.getOrigin().z();
+        const Real dx = dir.x(), dy = dir.y(), dz = dir.z();
+        Real tBuf[PRIMITIVE_BLOCK];
+        Real bestT = h.getT();
+        int best = -1;
+        for (int base = 0; base < n; base += PRIMITIVE_BLOCK) {
+            int len = std::min(PRIMITIVE_BLOCK, n - base);
+            const Real *px = &cx[base], *py = &cy[base], *pz = &cz[base], *pr = &r2[base];
+            #pragma omp simd
+            for (int i = 0; i < len; ++i) {
+                Real lx = px[i] - ox, ly = py[i] - oy, lz = pz[i] - oz;
+                Real l_len2 = lx * lx + ly * ly + lz * lz;
+                Real t_p = lx * dx + ly * dy + lz * dz;
+                Real td2 = pr[i] - (l_len2 - t_p * t_p);
+                bool outside = l_len2 > pr[i] + eps;
+                Real s = std::sqrt(std::max(td2, Real(0)));
+                Real t = outside ? t_p - s : t_p + s;
+                bool miss = (t_p < 0 && outside) || td2 < 0 || t < tmin - eps || t < 0;
+                tBuf[i] = miss ? Real(inf) : t;
+            }
+            for (int i = 0; i < len; ++i)
+                if (tBuf[i] < inf && tBuf[i] <= bestT + eps)
+                    bestT = tBuf[i], best = base + i;
+        }
+        if (best == -1) return false;
+        h.record(bestT, prims[best]);
+        return true;
+    }
+
+private:
+    std::vector<Real> cx, cy, cz, r2;
+    std::vector<const Sphere*> prims;
+};
+
+class PlaneList {
+public:
+    void add(const Plane *p) {
+        const Vector3f &n = p->getNormal();
+        nx.push_back(n.x()), ny.push_back(n.y()), nz.push_back(n.z());
+        d.push_back(p->getOffset());
+        prims.push_back(p);
+    }
+
+    void append(const PlaneList &l) {
+        nx.insert(nx.end(), l.nx.begin(), l.nx.end());
+        ny.insert(ny.end(), l.ny.begin(), l.ny.end());
+        nz.insert(nz.end(), l.nz.begin(), l.nz.end());
+        d.insert(d.end(), l.d.begin(), l.d.end());
+        prims.insert(prims.end(), l.prims.begin(), l.prims.end());
+    }
+
+    int size() const { return nx.size(); }
+
+    bool intersect(const Ray &r, Hit &h, Real tmin) const {
+        int n = size();
+        if (n == 0) return false;
+        Vector3f dir = r.getDirection().normalized();
+        const Real ox = r.getOrigin().x(), oy = r.getOrigin().y(), oz = r.getOrigin().z();
+        const Real dx = dir.x(), dy = dir.y(), dz = dir.z();
+        Real tBuf[PRIMITIVE_BLOCK];
+        Real bestT = h.getT();
+        int best = -1;
+        for (int base = 0; base < n; base += PRIMITIVE_BLOCK) {
+            int len = std::min(PRIMITIVE_BLOCK, n - base);
+            const Real *px = &nx[base], *py = &ny[base], *pz = &nz[base], *pd = &d[base];
+            #pragma omp simd
+            for (int i = 0; i < len; ++i) {
+                Real denom = px[i] * dx + py[i] * dy + pz[i] * dz;
+                bool parallel = std::fabs(denom) < eps;
+                Real t = -(pd[i] + px[i] * ox + py[i] * oy + pz[i] * oz) / (parallel ? Real(1) : denom);
+                tBuf[i] = (parallel || t < tmin - eps) ? Real(inf) : t;
+            }
+            for (int i = 0; i < len; ++i)
+                if (tBuf[i] < inf && tBuf[i] <= bestT + eps)
+                    bestT = tBuf[i], best = base + i;
+        }
+        if (best == -1) return false;
+        h.record(bestT, prims[best]);
+        return true;
+    }
+
+private:
+    std::vector<Real> nx, ny, nz, d;
+    std::vector<const Plane*> prims;
+};
+
+#endif //PRIMITIVE_LIST_H
@@ -0,0 +1,151 @@
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+enum ProgressCounter {
+    PROGRESS_PHOTONS,
+    PROGRESS_PIXELS,
+    PROGRESS_RAYS,
+    PROGRESS_GATHERS,
+    PROGRESS_COUNTERS
+};
+
+// Work counters for the photon and render phases. Worker threads only bump
+// counters in their own cache line; a separate reporter thread sums them and
+// prints rate and ETA every interval seconds, so the hot loops never touch
+// stdio. Each phase ends with a one line summary; quiet turns off the
+// periodic lines.
+class Progress {
+public:
+    Progress(bool quiet, double interval) : quiet(quiet), interval(interval), running(false) {
+        int n = 1;
+#ifdef _OPENMP
+        n = omp_get_max_threads();
+#endif
+        slots = std::vector<Slot>(n);
+    }
+
+    ~Progress() {
+        end();
+    }
+
+    Progress(const Progress &) = delete;
+    Progress &operator=(const Progress &) = delete;
+
+    void add(ProgressCounter c, uint64_t n = 1) {
+        int tid = 0;
+#ifdef _OPENMP
+        tid = omp_get_thread_num();
+#endif
+        slots[tid % slots.size()].count[c].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    uint64_t sum(ProgressCounter c) const {
+        uint64_t s = 0;
+        for (size_t i = 0; i < slots.size(); ++i)
+            s += slots[i].count[c].load(std::memory_order_relaxed);
+        return s;
+    }
+
+    // Start a phase that is done once counter has grown by total.
+    void begin(const char *phaseName, ProgressCounter counter, uint64_t total) {
+        end();
+        phase = phaseName, mainCounter = counter, target = total;
+        for (int c = 0; c < PROGRESS_COUNTERS; ++c)
+            base[c] = sum((ProgressCounter)c);
+        start = std::chrono::steady_clock::now();
+        running = true;
+        if (!quiet && interval > 0)
+            reporter = std::thread(&Progress::report, this);
+    }
+
+    void end() {
+        if (!running) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+        }
+        wake.notify_all();
+        if (reporter.joinable())
+            reporter.join();
+        double elapsed = seconds();
+        uint64_t done = sum(mainCounter) - base[mainCounter];
+        printf("%s: %llu %s in %.3lf s (%.0lf/s)", phase, (unsigned long long)done, name(mainCounter),
+               elapsed, elapsed > 0 ? done / elapsed : 0.0);
+        printOthers();
+        printf("\n");
+        fflush(stdout);
+    }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> count[PROGRESS_COUNTERS];
+        char pad[64 - PROGRESS_COUNTERS * sizeof(std::atomic<uint64_t>) % 64];
+        Slot() {
+            for (int c = 0; c < PROGRESS_COUNTERS; ++c)
+                count[c] = 0;
+        }
+        Slot(const Slot &) : Slot() {}
+    };
+
+    static const char *name(int c) {
+        static const char *names[PROGRESS_COUNTERS] = {"photons", "pixels", "rays", "gathers"};
+        return names[c];
+    }
+
+    double seconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void printOthers() const {
+        for (int c = 0; c < PROGRESS_COUNTERS; ++c) {
+            uint64_t n = sum((ProgressCounter)c) - base[c];
+            if (c != mainCounter && n > 0)
+                printf(", %s %llu", name(c), (unsigned long long)n);
+        }
+    }
+
+    void report() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!wake.wait_for(lock, std::chrono::duration<double>(interval), [this] { return !running; })) {
+            double elapsed = seconds();
+            uint64_t done = sum(mainCounter) - base[mainCounter];
+            double rate = elapsed > 0 ? done / elapsed : 0;
+            printf("%s: %llu/%llu %s (%.1lf%%), %.0lf/s", phase, (unsigned long long)done, (unsigned long long)target,
+                   name(mainCounter), target > 0 ? 100.0 * done / target : 100.0, rate);
+            if (rate > 0 && done < target)
+                printf(", ETA %.1lf s", (target - done) / rate);
+            printOthers();
+            printf("\n");
+            fflush(stdout);
+        }
+    }
+
+    bool quiet;
+    double interval;
+    std::vector<Slot> slots;
+
+    const char *phase = "";
+    ProgressCounter mainCounter = PROGRESS_PIXELS;
+    uint64_t target = 0, base[PROGRESS_COUNTERS];
+    std::chrono::steady_clock::time_point start;
+
+    bool running;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::thread reporter;
+};
+
+#endif // PROGRESS_H
@@ -0,0 +1,109 @@
+#ifndef PROJECTION_MAP_H
+#define PROJECTION_MAP_H
+
+#include <algorithm>
+#include <vector>
+#include <vecmath.h>
+
+#include "alias_table.hpp"
+#include "group.hpp"
+#include "hit.hpp"
+#include "importance_map.hpp"
+#include "light.hpp"
+#include "material.hpp"
+#include "sampler.hpp"
+#include "transform.hpp"
+
+// Which first hits make a projection map cell worth emitting into.
+enum ProjectionTarget {
+    PROJECT_GEOMETRY,   // anything in the scene
+    PROJECT_CAUSTIC     // reflective or refractive surfaces
+};
+
+// Grid over a light's emission domain (see Light::EmitPhoton) marking the
+// cells whose photons reach the target, found by tracing a few probe photons
+// per cell. Marked cells are grown by one cell so thin geometry between
+// probes is not lost. Photons are then only emitted into marked cells; the
+// light is picked with its power scaled by getCoverage(), so the photon
+// power stays the same as without the map.
+//
+// With an importance map, marked cells are further weighted by the visual
+// importance where their probes land (plus IMPORTANCE_FLOOR, as light also
+// reaches visible surfaces indirectly) and emit() rescales the photon power
+// by how much more or less often its cell is picked than a uniform cell.
+class ProjectionMap {
+public:
+    ProjectionMap(const Light *light, Group *group, int res, ProjectionTarget target,
+                  const ImportanceMap *importance = NULL) : res(res) {
+        std::vector<char> hit(res * res, 0);
+        std::vector<Real> seen(res * res, 0);
+        #pragma omp parallel for schedule(dynamic, 16)
+        for (int c = 0; c < res * res; ++c) {
+            int cx = c % res, cy = c / res;
+            for (int k = 0; k < PROBES_PER_SIDE * PROBES_PER_SIDE; ++k) {
+                Real u = (cx + (k % PROBES_PER_SIDE + ran()) / PROBES_PER_SIDE) / res;
+                Real v = (cy + (k / PROBES_PER_SIDE + ran()) / PROBES_PER_SIDE) / res;
+                Vector3f p;
+                if (!probe(light->EmitPhoton(u, v, ran(), ran()), group, target, p)) continue;
+                hit[c] = 1;
+                if (importance == NULL) break;
+                seen[c] += importance->get(p) / (PROBES_PER_SIDE * PROBES_PER_SIDE);
+            }
+        }
+        std::vector<Real> weights(res * res, 0);
+        int marked = 0;
+        for (int cy = 0; cy < res; ++cy)
+            for (int cx = 0; cx < res; ++cx) {
+                int c = cy * res + cx;
+                bool near = false;
+                Real w = 0;
+                for (int dy = -1; dy <= 1; ++dy)
+                    for (int dx = -1; dx <= 1; ++dx) {
+                        int nx = cx + dx, ny = cy + dy;
+                        if (nx < 0 || nx >= res || ny < 0 || ny >= res || !hit[ny * res + nx]) continue;
+                        near = true;
+                        w = std::max(w, seen[ny * res + nx]);
+                    }
+                if (!near) continue;
+                weights[c] = importance == NULL ? 1 : w + IMPORTANCE_FLOOR;
+                marked++;
+            }
+        coverage = Real(marked) / (res * res);
+        cells = AliasTable(weights);
+    }
+
+    // Fraction of the emission domain that is emitted into.
+    Real getCoverage() const {
+        return coverage;
+    }
+
+    Photon emit(const Light *light, SampleStream &stream) const {
+        int c = cells.sample(stream.next(), stream.next());
+        Real u = (c % res + stream.next()) / res, v = (c / res + stream.next()) / res;
+        Photon photon = light->EmitPhoton(u, v, stream.next(), stream.next());
+        // 1 when every marked cell is equally likely
+        photon.power *= 1 / (cells.pdf(c) * res * res * coverage);
+        return photon;
+    }
+
+private:
+    static const int PROBES_PER_SIDE = 2;
+    static constexpr Real IMPORTANCE_FLOOR = 0.1;
+
+    static bool probe(const Photon &photon, Group *group, ProjectionTarget target, Vector3f &p) {
+        Ray r(photon.position, photon.direction);
+        Hit hit;
+        if (!group->intersect(r, hit, 0)) return false;
+        p = r.pointAtParameter(hit.getT());
+        if (target == PROJECT_GEOMETRY) return true;
+        evalHit(r, hit);
+        Material *m = hit.getMaterial();
+        return m != NULL && (m->reflection > 1e-7 || m->refraction > 1e-7);
+    }
+
+    int res;
+    AliasTable cells;
+    Real coverage;
+};
+
+#endif // PROJECTION_MAP_H
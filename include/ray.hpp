@@ -27,7 +27,7 @@ public:
         return direction;
     }
 
-    Vector3f pointAtParameter(double t) const {
+    Vector3f pointAtParameter(Real t) const {
         return origin + direction * t;
     }
     
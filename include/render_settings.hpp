@@ -0,0 +1,162 @@
+#ifndef RENDER_SETTINGS_H
+#define RENDER_SETTINGS_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vecmath.h>
+
+#include "sampler.hpp"
+
+enum TileOrder {
+    TILE_ORDER_SCANLINE,
+    TILE_ORDER_MORTON,
+    TILE_ORDER_SPIRAL
+};
+
+// Which specular rays backwardTracing follows at a hit that both reflects
+// and refracts: both, both with Russian roulette on dim paths, or one of
+// them picked at random by weight.
+enum BranchMode {
+    BRANCH_ALL,
+    BRANCH_ROULETTE,
+    BRANCH_SINGLE
+};
+
+// Parameters of the renderer that are not part of the scene itself. They can
+// be given in an optional Render { key value ... } block of the scene file
+// and overridden by "key value" pairs on the command line.
+struct RenderSettings {
+    int emitPhoton = 3000000;
+    int maxInMap = 10000000;
+    int samplePhotons = 150000;
+    int sampleDist = 1;
+    bool antialiasing = false;
+    // adaptive anti-aliasing: samples per refined pixel, luminance contrast
+    // to a neighbour that triggers refinement, and the standard error of the
+    // pixel luminance at which refinement stops
+    int aaMinSamples = 4;
+    int aaMaxSamples = 16;
+    double aaContrast = 0.2;
+    double aaThreshold = 0.02;
+    // pixels per tile side; 0 renders one image column per task
+    int tileSize = 16;
+    TileOrder tileOrder = TILE_ORDER_MORTON;
+    // no periodic progress lines, only a summary per phase
+    bool quiet = false;
+    // seconds between progress lines
+    double progressInterval = 2;
+    // emit photons only towards cells of a projectionRes^2 grid over each
+    // light's emission that reach the scene
+    bool projectionMaps = false;
+    int projectionRes = 64;
+    // photons for a separate caustic map aimed at specular objects; 0 = none
+    int causticPhotons = 0;
+    // steer emission and photon storage by visual importance from
+    // importanceParticles camera particles (0 = four per pixel); photons
+    // out of sight are stored with probability importanceMinStore
+    bool importance = false;
+    int importanceParticles = 0;
+    double importanceMinStore = 0.1;
+    // sample lights with shadow rays at every gather, and keep only photons
+    // that bounced at least once; directSamples light samples per gather
+    bool directLighting = false;
+    int directSamples = 1;
+    // final gathering: the indirect light at a gather point is the photon
+    // map estimate at the surfaces seen by gatherRays stratified hemisphere
+    // rays, stored in an irradiance cache of accuracy cacheAccuracy (0 = a
+    // full gather at every point); light sources are sampled as with
+    // directLighting and caustics need causticPhotons
+    bool finalGather = false;
+    int gatherRays = 128;
+    double cacheAccuracy = 0.15;
+    // sum photons by kd-tree subtree where a gather takes all photons in
+    // its radius; subtrees straddling the radius are taken or skipped whole
+    // if within aggregateTolerance of it (relative, 0 = exact)
+    bool aggregateGathers = false;
+    double aggregateTolerance = 0;
+    // nearest photon searches may return photons up to 1 + epsilon times
+    // farther than the true k nearest, in the global and the caustic map
+    double knnEpsilon = 0;
+    double causticKnnEpsilon = 0;
+    // irradiance at mesh vertices, gathered after the photon pass and saved
+    // next to each mesh (bakeIrradiance) or loaded from there (useBaked),
+    // replaces the gathers on meshes; direct light is still sampled
+    bool bakeIrradiance = false;
+    bool useBaked = false;
+    // trace photons against copies of the purely diffuse meshes simplified
+    // to at most this many triangles each (0 = full meshes)
+    int proxyTriangles = 0;
+    // random numbers for emission, bounces, pixel and lens samples
+    SamplerType sampler = SAMPLER_RANDOM;
+    // trace each tile breadth-first as one batch (see wavefront.hpp)
+    bool wavefront = false;
+    // run each wave's photon gathers in Morton order; implies wavefront
+    bool sortGathers = false;
+    BranchMode branchMode = BRANCH_ALL;
+    // paths whose throughput falls below this are not traced further
+    // (0 = trace every path, as before pruning existed)
+    double pathThreshold = 0;
+    // throughput below which Russian roulette starts in roulette mode
+    double rouletteThreshold = 0.1;
+
+    // Returns false if the key is unknown or the value is invalid.
+    bool set(const char *key, const char *value) {
+        if (!strcmp(key, "emitPhoton")) emitPhoton = atoi(value);
+        else if (!strcmp(key, "maxInMap")) maxInMap = atoi(value);
+        else if (!strcmp(key, "samplePhotons")) samplePhotons = atoi(value);
+        else if (!strcmp(key, "sampleDist")) sampleDist = atoi(value);
+        else if (!strcmp(key, "antialiasing")) antialiasing = atoi(value) != 0;
+        else if (!strcmp(key, "aaMinSamples")) aaMinSamples = atoi(value);
+        else if (!strcmp(key, "aaMaxSamples")) aaMaxSamples = atoi(value);
+        else if (!strcmp(key, "aaContrast")) aaContrast = atof(value);
+        else if (!strcmp(key, "aaThreshold")) aaThreshold = atof(value);
+        else if (!strcmp(key, "tileSize")) tileSize = atoi(value);
+        else if (!strcmp(key, "quiet")) quiet = atoi(value) != 0;
+        else if (!strcmp(key, "progressInterval")) progressInterval = atof(value);
+        else if (!strcmp(key, "projectionMaps")) projectionMaps = atoi(value) != 0;
+        else if (!strcmp(key, "projectionRes")) projectionRes = atoi(value);
+        else if (!strcmp(key, "causticPhotons")) causticPhotons = atoi(value);
+        else if (!strcmp(key, "importance")) importance = atoi(value) != 0;
+        else if (!strcmp(key, "importanceParticles")) importanceParticles = atoi(value);
+        else if (!strcmp(key, "importanceMinStore")) importanceMinStore = atof(value);
+        else if (!strcmp(key, "wavefront")) wavefront = atoi(value) != 0;
+        else if (!strcmp(key, "sortGathers")) sortGathers = atoi(value) != 0;
+        else if (!strcmp(key, "pathThreshold")) pathThreshold = atof(value);
+        else if (!strcmp(key, "rouletteThreshold")) rouletteThreshold = atof(value);
+        else if (!strcmp(key, "branchMode")) {
+            if (!strcmp(value, "all")) branchMode = BRANCH_ALL;
+            else if (!strcmp(value, "roulette")) branchMode = BRANCH_ROULETTE;
+            else if (!strcmp(value, "single")) branchMode = BRANCH_SINGLE;
+            else return false;
+        }
+        else if (!strcmp(key, "directLighting")) directLighting = atoi(value) != 0;
+        else if (!strcmp(key, "directSamples")) directSamples = atoi(value);
+        else if (!strcmp(key, "finalGather")) finalGather = atoi(value) != 0;
+        else if (!strcmp(key, "gatherRays")) gatherRays = atoi(value);
+        else if (!strcmp(key, "cacheAccuracy")) cacheAccuracy = atof(value);
+        else if (!strcmp(key, "aggregateGathers")) aggregateGathers = atoi(value) != 0;
+        else if (!strcmp(key, "aggregateTolerance")) aggregateTolerance = atof(value);
+        else if (!strcmp(key, "knnEpsilon")) knnEpsilon = atof(value);
+        else if (!strcmp(key, "causticKnnEpsilon")) causticKnnEpsilon = atof(value);
+        else if (!strcmp(key, "bakeIrradiance")) bakeIrradiance = atoi(value) != 0;
+        else if (!strcmp(key, "useBaked")) useBaked = atoi(value) != 0;
+        else if (!strcmp(key, "proxyTriangles")) proxyTriangles = atoi(value);
+        else if (!strcmp(key, "sampler")) {
+            if (!strcmp(value, "random")) sampler = SAMPLER_RANDOM;
+            else if (!strcmp(value, "halton")) sampler = SAMPLER_HALTON;
+            else if (!strcmp(value, "sobol")) sampler = SAMPLER_SOBOL;
+            else return false;
+        }
+        else if (!strcmp(key, "tileOrder")) {
+            if (!strcmp(value, "scanline")) tileOrder = TILE_ORDER_SCANLINE;
+            else if (!strcmp(value, "morton")) tileOrder = TILE_ORDER_MORTON;
+            else if (!strcmp(value, "spiral")) tileOrder = TILE_ORDER_SPIRAL;
+            else return false;
+        }
+        else return false;
+        return true;
+    }
+};
+
+#endif // RENDER_SETTINGS_H
@@ -0,0 +1,139 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include <vecmath.h>
+
+#define ran() ( Real( rand() % RAND_MAX ) / RAND_MAX )
+
+enum SamplerType {
+    SAMPLER_RANDOM,
+    SAMPLER_HALTON,
+    SAMPLER_SOBOL
+};
+
+// Low-discrepancy sequences for the random decisions of the renderer. A
+// point of the sequence is one photon path or one pixel sample, and each
+// random number it needs is one dimension of that point (see SampleStream).
+// Sobol points are scrambled by a random digital shift and Halton points by
+// random digit permutations plus a rotation, both derived from the scramble
+// value, so different pixels get decorrelated copies of the same sequence.
+// Dimensions beyond the tables fall back to hashed random numbers.
+class Sampler {
+public:
+    Sampler(SamplerType type = SAMPLER_RANDOM, uint32_t seed = 0) : type(type), seed(seed) {
+        if (type == SAMPLER_SOBOL)
+            initSobol();
+        if (type == SAMPLER_HALTON)
+            initHalton();
+    }
+
+    SamplerType getType() const {
+        return type;
+    }
+
+    // Component dim of point index, in [0, 1).
+    Real get(uint32_t index, int dim, uint32_t scramble) const {
+        uint32_t shift = hash(seed ^ hash(scramble + 0x9e3779b9u * (dim + 1)));
+        Real u;
+        if (type == SAMPLER_SOBOL && dim < SOBOL_DIMS) {
+            uint32_t x = 0;
+            for (int b = 0; index; index >>= 1, ++b)
+                if (index & 1) x ^= sobolV[dim][b];
+            u = (x ^ shift) * Real(1.0 / 4294967296.0);
+        }
+        else if (type == SAMPLER_HALTON && dim < HALTON_DIMS) {
+            u = haltonInverse(index, dim) + shift * Real(1.0 / 4294967296.0);
+            if (u >= 1) u -= 1;
+        }
+        else
+            u = hash(index ^ hash(shift)) * Real(1.0 / 4294967296.0);
+        return std::min(u, Real(ONE_MINUS_EPS));
+    }
+
+    static uint32_t hash(uint32_t x) {
+        x ^= x >> 16, x *= 0x7feb352du;
+        x ^= x >> 15, x *= 0x846ca68bu;
+        x ^= x >> 16;
+        return x;
+    }
+
+private:
+    static const int SOBOL_DIMS = 16, HALTON_DIMS = 16;
+    static constexpr double ONE_MINUS_EPS = 0.99999994;
+
+    void initSobol() {
+        // primitive polynomial degree s, coefficients a and initial direction
+        // numbers m of dimensions 2..16 (Joe and Kuo)
+        static const int s[SOBOL_DIMS] = {0, 1, 2, 3, 3, 4, 4, 5, 5, 5, 5, 5, 5, 6, 6, 6};
+        static const int a[SOBOL_DIMS] = {0, 0, 1, 1, 2, 1, 4, 2, 4, 7, 11, 13, 14, 1, 13, 16};
+        static const uint32_t m[SOBOL_DIMS][6] = {
+            {0}, {1}, {1, 3}, {1, 3, 1}, {1, 1, 1}, {1, 1, 3, 3}, {1, 3, 5, 13}, {1, 1, 5, 5, 17},
+            {1, 1, 5, 5, 5}, {1, 1, 7, 11, 19}, {1, 1, 5, 1, 1}, {1, 1, 1, 3, 11}, {1, 3, 5, 5, 31},
+            {1, 3, 3, 9, 7, 49}, {1, 1, 1, 15, 21, 21}, {1, 3, 1, 13, 27, 49}};
+        for (int b = 0; b < 32; ++b)
+            sobolV[0][b] = 1u << (31 - b);
+        for (int d = 1; d < SOBOL_DIMS; ++d) {
+            for (int b = 0; b < s[d]; ++b)
+                sobolV[d][b] = m[d][b] << (31 - b);
+            for (int b = s[d]; b < 32; ++b) {
+                uint32_t v = sobolV[d][b - s[d]] ^ (sobolV[d][b - s[d]] >> s[d]);
+                for (int k = 1; k < s[d]; ++k)
+                    if ((a[d] >> (s[d] - 1 - k)) & 1) v ^= sobolV[d][b - k];
+                sobolV[d][b] = v;
+            }
+        }
+    }
+
+    void initHalton() {
+        static const int primes[HALTON_DIMS] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53};
+        for (int d = 0; d < HALTON_DIMS; ++d) {
+            int b = primes[d];
+            base[d] = b;
+            // permutation of the non-zero digits, so trailing zeros stay zero
+            perm[d].resize(b);
+            for (int i = 0; i < b; ++i)
+                perm[d][i] = i;
+            for (int i = b - 1; i > 1; --i)
+                std::swap(perm[d][i], perm[d][1 + hash(seed ^ (d * 131 + i)) % i]);
+        }
+    }
+
+    Real haltonInverse(uint32_t index, int dim) const {
+        int b = base[dim];
+        Real inv = Real(1) / b, f = inv, u = 0;
+        for (; index; index /= b, f *= inv)
+            u += perm[dim][index % b] * f;
+        return u;
+    }
+
+    SamplerType type;
+    uint32_t seed;
+    uint32_t sobolV[SOBOL_DIMS][32];
+    int base[HALTON_DIMS];
+    std::vector<int> perm[HALTON_DIMS];
+};
+
+// The random numbers of one sample: the k-th call to next() returns
+// dimension k of point index. With the random sampler it is ran().
+class SampleStream {
+public:
+    SampleStream(const Sampler *sampler, uint32_t index, uint32_t scramble)
+        : sampler(sampler), index(index), scramble(scramble), dim(0) {}
+
+    Real next() {
+        if (sampler == NULL || sampler->getType() == SAMPLER_RANDOM)
+            return ran();
+        return sampler->get(index, dim++, scramble);
+    }
+
+private:
+    const Sampler *sampler;
+    uint32_t index, scramble;
+    int dim;
+};
+
+#endif // SAMPLER_H
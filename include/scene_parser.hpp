@@ -25,6 +25,7 @@
 #include "plane.hpp"
 #include "triangle.hpp"
 #include "transform.hpp"
+#include "render_settings.hpp"
 
 #define MAX_PARSER_TOKEN_LENGTH 1024
 
@@ -53,6 +54,10 @@ public:
         return lights[i];
     }
 
+    Light **getLights() const {
+        return lights;
+    }
+
     int getNumMaterials() const {
         return num_materials;
     }
@@ -65,12 +70,17 @@ public:
     Group *getGroup() const {
         return group;
     }
+
+    RenderSettings &getSettings() {
+        return settings;
+    }
     int num_lights;
 private:
 
     void parseFile();
     void parsePerspectiveCamera();
     void parseBackground();
+    void parseRender();
     void parseLights();
     Light *parsePointLight();
     Light *parseAreaLight();
@@ -102,6 +112,10 @@ private:
     Material **materials;
     Material *current_material;
     Group *group;
+    RenderSettings settings;
+    // Transforms open around the object being parsed; a hit records at most
+    // MAX_INSTANCE_DEPTH of them.
+    int transformDepth;
 };
 
 #endif // SCENE_PARSER_H
@@ -17,7 +17,7 @@ public:
         this->radius2 = 1;
     }
     
-    Sphere(const Vector3f &center, float radius, Material *material) : Object3D(material) {
+    Sphere(const Vector3f &center, Real radius, Material *material) : Object3D(material) {
         // 
         this->center = center;
         this->radius = radius;
@@ -26,37 +26,44 @@ public:
 
     ~Sphere() override = default;
 
-    bool intersect(const Ray &r, Hit &h, double tmin) {
+    bool intersect(const Ray &r, Hit &h, Real tmin) override {
         //
         Vector3f l = center - r.getOrigin();
-        float l_len2 = norm2(l);
-        float t_p = Vector3f::dot(l, r.getDirection().normalized());
+        Real l_len2 = norm2(l);
+        Real t_p = Vector3f::dot(l, r.getDirection().normalized());
         if(t_p < 0 && l_len2 > radius2 + eps) 
             return false;
-        float d2 = l_len2 - t_p*t_p;
+        Real d2 = l_len2 - t_p*t_p;
         if(d2 > radius2) 
             return false;
-        float td2 = radius2 - d2;
+        Real td2 = radius2 - d2;
 
-        float t;
+        Real t;
         if(l_len2 > radius2 + eps) t = t_p - sqrt(td2);
         else t = t_p + sqrt(td2);
         if (t > h.getT() + eps || t < tmin - eps || t < 0)
             return false;
 
-        Vector3f n = r.pointAtParameter(t) - center;
-        n = n.normalized();
-        if (l_len2 > radius2 + eps) 
-            h.set(t, material, n, 0, 0);
-        else h.set(t, material, -n, 0, 0);
+        h.record(t, this);
         return true;
     }
 
+    void computeHit(const Ray &r, Hit &h) const override {
+        Vector3f n = r.pointAtParameter(h.getT()) - center;
+        n = n.normalized();
+        if ((center - r.getOrigin()).squaredLength() > radius2 + eps)
+            h.set(h.getT(), material, n, 0, 0);
+        else h.set(h.getT(), material, -n, 0, 0);
+    }
+
+    const Vector3f &getCenter() const { return center; }
+    Real getRadius() const { return radius; }
+
 protected:
 
     Vector3f center;
-    float radius;
-    float radius2;
+    Real radius;
+    Real radius2;
 
 };
 
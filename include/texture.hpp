@@ -0,0 +1,75 @@
+#ifndef TEXTURE_H
+#define TEXTURE_H
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include <vecmath.h>
+
+// Textures are kept as 8-bit RGB with a full mip pyramid. Each level is
+// stored in TEXTURE_TILE x TEXTURE_TILE tiles so that texels close in 2D are
+// close in memory. (0,0) is the bottom left corner, as in Image.
+#define TEXTURE_TILE_LOG 3
+#define TEXTURE_TILE (1 << TEXTURE_TILE_LOG)
+
+class Texture {
+public:
+    // rows points to row y = 0 of w * h packed RGB (or BGR) texels and
+    // stride is the byte offset from one row to the next, possibly negative
+    Texture(int w, int h, const unsigned char *rows, long stride, bool bgr = false);
+
+    // binary PPM (P6) or uncompressed 24-bit TGA
+    static Texture *Load(const char *filename);
+
+    int Width() const { return levels[0].width; }
+    int Height() const { return levels[0].height; }
+    int NumLevels() const { return levels.size(); }
+    size_t Bytes() const;
+
+    Vector3f GetTexel(int level, int x, int y) const {
+        const MipLevel &l = levels[level];
+        assert(x >= 0 && x < l.width);
+        assert(y >= 0 && y < l.height);
+        const unsigned char *p = &l.texels[3 * l.offset(x, y)];
+        return Vector3f(p[0] / 255.0, p[1] / 255.0, p[2] / 255.0);
+    }
+
+    // Point sample at texel coordinates (u, v) of level 0, wrapping around.
+    // footprint is the size of the sampled area in level 0 texels; the level
+    // whose texels are about that size is used.
+    Vector3f Sample(Real u, Real v, Real footprint) const {
+        int x = (int)u % Width();
+        if (x < 0) x += Width();
+        int y = (int)v % Height();
+        if (y < 0) y += Height();
+        int level = 0;
+        if (footprint >= 2)
+            level = std::min(NumLevels() - 1, (int)std::ilogb(footprint));
+        const MipLevel &l = levels[level];
+        return GetTexel(level, std::min(x >> level, l.width - 1), std::min(y >> level, l.height - 1));
+    }
+
+private:
+    struct MipLevel {
+        int width, height, tilesX;
+        std::vector<unsigned char> texels;
+
+        size_t offset(int x, int y) const {
+            size_t tile = (size_t)(y >> TEXTURE_TILE_LOG) * tilesX + (x >> TEXTURE_TILE_LOG);
+            return tile * TEXTURE_TILE * TEXTURE_TILE + ((y & (TEXTURE_TILE - 1)) << TEXTURE_TILE_LOG) + (x & (TEXTURE_TILE - 1));
+        }
+        void init(int w, int h) {
+            width = w, height = h;
+            tilesX = (w + TEXTURE_TILE - 1) >> TEXTURE_TILE_LOG;
+            int tilesY = (h + TEXTURE_TILE - 1) >> TEXTURE_TILE_LOG;
+            texels.assign((size_t)3 * tilesX * tilesY * TEXTURE_TILE * TEXTURE_TILE, 0);
+        }
+    };
+
+    void buildMipmaps();
+
+    std::vector<MipLevel> levels;
+};
+
+#endif // TEXTURE_H
@@ -0,0 +1,130 @@
+#ifndef TILE_SCHEDULER_H
+#define TILE_SCHEDULER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "render_settings.hpp"
+
+// Rectangle of pixels [x0, x1) x [y0, y1).
+struct Tile {
+    int x0, y0, x1, y1;
+};
+
+// Splits the image into tiles, sorts them along a space filling order and
+// hands each thread a contiguous run of the sorted list, so neighbouring
+// tiles are rendered by the same thread. A thread takes tiles from the front
+// of its own run; once that is empty it steals from the back of the others.
+// A tile size of 0 gives one tile per image column.
+class TileScheduler {
+public:
+    TileScheduler(int W, int H, int tileSize, TileOrder order) {
+        if (tileSize <= 0) {
+            for (int x = 0; x < W; ++x)
+                tiles.push_back(Tile{x, 0, x + 1, H});
+            return;
+        }
+        int tilesX = (W + tileSize - 1) / tileSize, tilesY = (H + tileSize - 1) / tileSize;
+        std::vector<std::pair<uint64_t, Tile> > keyed;
+        for (int ty = 0; ty < tilesY; ++ty)
+            for (int tx = 0; tx < tilesX; ++tx) {
+                Tile t{tx * tileSize, ty * tileSize, std::min(W, (tx + 1) * tileSize), std::min(H, (ty + 1) * tileSize)};
+                keyed.push_back(std::make_pair(orderKey(tx, ty, tilesX, tilesY, order), t));
+            }
+        std::stable_sort(keyed.begin(), keyed.end(),
+            [](const std::pair<uint64_t, Tile> &a, const std::pair<uint64_t, Tile> &b) { return a.first < b.first; });
+        for (size_t i = 0; i < keyed.size(); ++i)
+            tiles.push_back(keyed[i].second);
+    }
+
+    int numTiles() const { return tiles.size(); }
+    const Tile &getTile(int i) const { return tiles[i]; }
+
+    // Calls f(tile) once for every tile, in parallel.
+    template <class F>
+    void run(F f) const {
+        int numDeques = 1;
+#ifdef _OPENMP
+        numDeques = omp_get_max_threads();
+#endif
+        int n = tiles.size();
+        std::vector<Deque> deques(numDeques);
+        for (int t = 0; t < numDeques; ++t)
+            deques[t].range = pack((int64_t)n * t / numDeques, (int64_t)n * (t + 1) / numDeques);
+
+        #pragma omp parallel
+        {
+            int self = 0;
+#ifdef _OPENMP
+            self = omp_get_thread_num();
+#endif
+            int i;
+            while ((i = popFront(deques[self])) != -1)
+                f(tiles[i]);
+            // own run is empty: steal until every run is
+            for (int k = 1; k < numDeques; ++k) {
+                Deque &victim = deques[(self + k) % numDeques];
+                while ((i = popBack(victim)) != -1) {
+                    f(tiles[i]);
+                    k = 0;
+                }
+            }
+        }
+    }
+
+private:
+    // [head, tail) of a thread's run, packed so that the owner and thieves
+    // can both update it with a single compare-and-swap.
+    struct Deque {
+        std::atomic<uint64_t> range;
+        char pad[64 - sizeof(std::atomic<uint64_t>)];
+        Deque() : range(0) {}
+    };
+
+    static uint64_t pack(uint64_t head, uint64_t tail) { return head << 32 | tail; }
+
+    static int popFront(Deque &d) {
+        uint64_t r = d.range.load();
+        while (true) {
+            uint32_t head = r >> 32, tail = r & 0xffffffffu;
+            if (head >= tail) return -1;
+            if (d.range.compare_exchange_weak(r, pack(head + 1, tail))) return head;
+        }
+    }
+
+    static int popBack(Deque &d) {
+        uint64_t r = d.range.load();
+        while (true) {
+            uint32_t head = r >> 32, tail = r & 0xffffffffu;
+            if (head >= tail) return -1;
+            if (d.range.compare_exchange_weak(r, pack(head, tail - 1))) return tail - 1;
+        }
+    }
+
+    static uint64_t orderKey(int tx, int ty, int tilesX, int tilesY, TileOrder order) {
+        if (order == TILE_ORDER_MORTON) {
+            uint64_t key = 0;
+            for (int b = 0; b < 16; ++b)
+                key |= (uint64_t)((tx >> b) & 1) << (2 * b) | (uint64_t)((ty >> b) & 1) << (2 * b + 1);
+            return key;
+        }
+        if (order == TILE_ORDER_SPIRAL) {
+            // rings around the centre, each walked by angle
+            Real dx = tx - (tilesX - 1) / 2.0, dy = ty - (tilesY - 1) / 2.0;
+            uint64_t ring = (uint64_t)std::max(std::fabs(dx), std::fabs(dy));
+            Real angle = std::atan2(dy, dx) + M_PI;
+            return ring << 32 | (uint64_t)(angle / (2 * M_PI) * 0xffffffffu);
+        }
+        return (uint64_t)ty * tilesX + tx;
+    }
+
+    std::vector<Tile> tiles;
+};
+
+#endif // TILE_SCHEDULER_H
@@ -26,15 +26,25 @@ public:
     ~Transform() {
     }
 
-    virtual bool intersect(const Ray &r, Hit &h, double tmin) {
+    virtual bool intersect(const Ray &r, Hit &h, Real tmin) {
+        bool inter = o->intersect(toLocal(r), h, tmin);
+        if (inter)
+            h.pushInstance(this);
+        return inter;
+    }
+
+    void findMeshes(const Matrix4f &toWorld, std::vector<std::pair<Mesh*, Matrix4f> > &out) override {
+        o->findMeshes(toWorld * transform.inverse(), out);
+    }
+
+    Ray toLocal(const Ray &r) const {
         Vector3f trSource = transformPoint(transform, r.getOrigin());
         Vector3f trDirection = transformDirection(transform, r.getDirection());
-        Ray tr(trSource, trDirection);
-        bool inter = o->intersect(tr, h, tmin);
-        if (inter) {
-            h.set(h.getT(), h.getMaterial(), transformDirection(transform.transposed(), h.getNormal()).normalized(), 0, 0);
-        }
-        return inter;
+        return Ray(trSource, trDirection);
+    }
+
+    Vector3f normalToWorld(const Vector3f &n) const {
+        return transformDirection(transform.transposed(), n).normalized();
     }
 
 protected:
@@ -42,4 +52,18 @@ protected:
     Matrix4f transform;
 };
 
+// Evaluate normal, material and texture coordinates of the closest hit found
+// by intersect. The ray is taken down the instance chain to the primitive,
+// and the normal is brought back up.
+inline void evalHit(const Ray &r, Hit &h) {
+    Ray local = r;
+    for (int i = h.getNumInstances() - 1; i >= 0; --i)
+        local = h.getInstance(i)->toLocal(local);
+    h.getObject()->computeHit(local, h);
+    Vector3f n = h.getNormal();
+    for (int i = 0; i < h.getNumInstances(); ++i)
+        n = h.getInstance(i)->normalToWorld(n);
+    h.setNormal(n);
+}
+
 #endif //TRANSFORM_H
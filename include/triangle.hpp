@@ -14,10 +14,16 @@ class Triangle: public Object3D {
 public:
 	
 	Vector3f normal;
-	double d;
+	Real d;
 	Vector3f vertices[3];
 
 	int textureVertex[3], normalVectorID[3];
+	int id = -1; // index in the owning mesh, used by the kd-tree cache
+	// 0-based vertex indices in the owning mesh (-1 if absent), and its
+	// baked irradiance: two values per vertex, on the side the normal
+	// points to and on the other
+	int vertexID[3] = {-1, -1, -1};
+	const Vector3f *baked = NULL;
 
 	Triangle(Material* m) : Object3D(m) {}
 	Triangle() = delete;
@@ -27,17 +33,17 @@ public:
 		vertices[0] = a, vertices[1] = b, vertices[2] = c;
 	}
 
-	double det(Vector3f A, Vector3f B, Vector3f C) {
+	Real det(Vector3f A, Vector3f B, Vector3f C) {
 		return A.x() * (B.y()*C.z() - C.y()*B.z()) - B.x() * (A.y()*C.z() - C.y()*A.z()) + C.x() * (A.y()*B.z() - B.y()*A.z());
 	}
 
-	Vector3f check(Vector3f A, Vector3f B, Vector3f C, Vector3f Res, double a, double b, double c) {
+	Vector3f check(Vector3f A, Vector3f B, Vector3f C, Vector3f Res, Real a, Real b, Real c) {
 		return a*A+b*B+c*C - Res;
 	}
 
-	bool intersect( const Ray& ray,  Hit& hit , double tmin) override {
+	bool intersect( const Ray& ray,  Hit& hit , Real tmin) override {
 		if(abs(Vector3f::dot(normal, ray.getDirection())) < eps) return false; //!!!!!!
-        double t = (d - Vector3f::dot(normal, ray.getOrigin())) / Vector3f::dot(normal, ray.getDirection());
+        Real t = (d - Vector3f::dot(normal, ray.getOrigin())) / Vector3f::dot(normal, ray.getDirection());
         if (t >= hit.getT() || t < tmin || t < 0)
             return false;
 		
@@ -53,20 +59,35 @@ public:
 		// }
 
 		if (0 <= res.y() && 0 <= res.z() && 0 <= res.x()) {
-			Vector3f n = normal;
-			if (Vector3f::dot(ray.getDirection(), n) > 0)
-				n = -n;
-			hit.set(t, material, n, 0, 0);
+			// h1, h2 and h3 span the parts of the triangle facing vertices 2, 0 and 1
+			Real a1 = Vector3f::dot(h3, normal), a2 = Vector3f::dot(h1, normal);
+			Real area = Vector3f::dot(h2, normal) + a1 + a2;
+			hit.record(t, this, area != 0 ? Vector2f(a1 / area, a2 / area) : Vector2f(0));
 			return true;
 		}
         return false;
 	}
 
-	double MinCoord(int coord) {
+	void computeHit(const Ray &ray, Hit &hit) const override {
+		Vector3f n = normal;
+		bool back = Vector3f::dot(ray.getDirection(), n) > 0;
+		if (back)
+			n = -n;
+		hit.set(hit.getT(), material, n, 0, 0);
+		if (baked != NULL && vertexID[0] >= 0 && vertexID[1] >= 0 && vertexID[2] >= 0) {
+			// barycentric interpolation of the side the ray arrived from
+			Real b1 = hit.getBarycentric().x(), b2 = hit.getBarycentric().y();
+			int side = back ? 1 : 0;
+			hit.setBakedIrradiance((1 - b1 - b2) * baked[2 * vertexID[0] + side] + b1 * baked[2 * vertexID[1] + side] +
+			                       b2 * baked[2 * vertexID[2] + side]);
+		}
+	}
+
+	Real MinCoord(int coord) {
 		return min(vertices[0][coord], min(vertices[1][coord],vertices[2][coord]));
 	}
 
-	double MaxCoord(int coord) {
+	Real MaxCoord(int coord) {
 		return max(vertices[0][coord], max(vertices[1][coord],vertices[2][coord]));
 	}
 
@@ -0,0 +1,114 @@
+#ifndef WAVEFRONT_H
+#define WAVEFRONT_H
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <vecmath.h>
+
+#include "hit.hpp"
+#include "photonmapping.hpp"
+#include "ray.hpp"
+
+// Breadth-first counterpart of PhotonMapping::backwardTracing. A batch of
+// camera rays goes through the pipeline one bounce at a time: every ray of
+// the wave is intersected, light hits are added, diffuse hits are gathered
+// together, and the surviving reflected and refracted rays are compacted into
+// the next wave. Each stage runs over the whole wave, so the intersection and
+// gather stages see long runs of similar queries instead of alternating with
+// shading; with sortGathers the gathers are also run in Morton order of their
+// positions. The result is the same as tracing each ray with backwardTracing.
+class Wavefront {
+public:
+    Wavefront(PhotonMapping *photonMapping) : photonMapping(photonMapping) {}
+
+    // Traces camera rays and writes one clamped color per ray to colors.
+    void trace(const std::vector<Ray> &rays, std::vector<Vector3f> &colors) {
+        colors.assign(rays.size(), photonMapping->sceneparser->getBackgroundColor());
+        wave.clear(), slots.clear();
+        for (size_t i = 0; i < rays.size(); ++i) {
+            wave.push_back(PathVertex{rays[i].getOrigin(), rays[i].getDirection(), Vector3f(1), 1, 1, Vector3f(0)});
+            slots.push_back(i);
+        }
+        while (!wave.empty()) {
+            intersect();
+            shade(colors);
+            spawn();
+        }
+        for (size_t i = 0; i < colors.size(); ++i)
+            colors[i] = PhotonMapping::clampColor(colors[i]);
+    }
+
+private:
+    void intersect() {
+        int n = wave.size();
+        hits.assign(n, Hit());
+        hitFlags.assign(n, 0);
+        for (int i = 0; i < n; ++i) {
+            Ray r(wave[i].origin, wave[i].direction);
+            if (photonMapping->baseGroup->intersect(r, hits[i], 0)) {
+                evalHit(r, hits[i]);
+                hitFlags[i] = 1;
+            }
+        }
+        if (photonMapping->progress != NULL)
+            photonMapping->progress->add(PROGRESS_RAYS, n);
+    }
+
+    // Light hits first, then the photon gathers of all diffuse hits.
+    void shade(std::vector<Vector3f> &colors) {
+        gathers.clear();
+        for (int i = 0; i < (int)wave.size(); ++i) {
+            Ray r(wave[i].origin, wave[i].direction);
+            if (photonMapping->seesLight(r, hitFlags[i], hits[i]))
+                colors[slots[i]] += wave[i].throughput;
+            if (hitFlags[i] && hits[i].getMaterial()->diffusion > EPS)
+                gathers.push_back(i);
+        }
+        if (photonMapping->settings->sortGathers) {
+            // query the photon map in Morton order of the gather points
+            keyed.clear();
+            for (size_t g = 0; g < gathers.size(); ++g) {
+                int i = gathers[g];
+                Vector3f p = wave[i].origin + wave[i].direction * hits[i].getT();
+                keyed.push_back(std::make_pair(photonMapping->map->mortonCode(p), i));
+            }
+            std::sort(keyed.begin(), keyed.end());
+            for (size_t g = 0; g < keyed.size(); ++g)
+                gathers[g] = keyed[g].second;
+        }
+        for (size_t g = 0; g < gathers.size(); ++g) {
+            int i = gathers[g];
+            Ray r(wave[i].origin, wave[i].direction);
+            colors[slots[i]] += wave[i].throughput * photonMapping->backwardDiff(&hits[i], &r);
+        }
+    }
+
+    // Builds the next wave from the continuations that survive pruning.
+    void spawn() {
+        nextWave.clear(), nextSlots.clear();
+        PathVertex out[2];
+        for (int i = 0; i < (int)wave.size(); ++i) {
+            if (!hitFlags[i]) continue;
+            Ray r(wave[i].origin, wave[i].direction);
+            int n = photonMapping->spawnVertices(&hits[i], &r, wave[i], out);
+            for (int k = 0; k < n; ++k) {
+                nextWave.push_back(out[k]);
+                nextSlots.push_back(slots[i]);
+            }
+        }
+        wave.swap(nextWave);
+        slots.swap(nextSlots);
+    }
+
+    PhotonMapping *photonMapping;
+    std::vector<PathVertex> wave, nextWave;
+    std::vector<int> slots, nextSlots;
+    std::vector<Hit> hits;
+    std::vector<char> hitFlags;
+    std::vector<int> gathers;
+    std::vector<std::pair<uint32_t, int> > keyed;
+};
+
+#endif // WAVEFRONT_H
@@ -1,8 +1,13 @@
 #include <cstdlib>
 #include <cstdio>
 #include <cstring>
+#include <cctype>
 
 #include "image.hpp"
+#include "mapped_file.hpp"
+
+// Images at least this large are converted by several threads.
+#define IMAGE_PARALLEL_TEXELS (1 << 20)
 
 // some helper functions for save & load
 
@@ -20,7 +25,7 @@ void WriteByte( FILE* file, unsigned char b )
     assert( success == 1 );
 }
 
-unsigned char ClampColorComponent( double c )
+unsigned char ClampColorComponent( Real c )
 {
     int tmp = int( c * 255 );
     
@@ -75,47 +80,47 @@ void Image::SaveTGA( const char* filename) const
     fclose(file);
 }
 
+const unsigned char *ReadTGAHeader(const char *data, size_t size, int &width, int &height) {
+    const unsigned char *h = (const unsigned char *)data;
+    if (data == NULL || size < 18) return NULL;
+    // uncompressed true color, 24 bits, top-left origin, no id or color map
+    if (h[2] != 2 || h[16] != 24 || h[17] != 32) return NULL;
+    for (int i = 0; i < 12; i++)
+        if (i != 2 && h[i] != 0) return NULL;
+    width = h[12] + 256 * h[13];
+    height = h[14] + 256 * h[15];
+    if (size < 18 + (size_t)3 * width * height) return NULL;
+    return h + 18;
+}
+
 Image* Image::LoadTGA(const char *filename) {
     assert(filename != NULL);
     // must end in .tga
     const char *ext = &filename[strlen(filename)-4];
     assert(!strcmp(ext,".tga"));
-    FILE *file = fopen(filename,"rb");
-    // misc header information
+    MappedFile file(filename);
     int width = 0;
     int height = 0;
-    for (int i = 0; i < 18; i++) {
-        unsigned char tmp;
-        tmp = ReadByte(file);
-        if (i == 2) assert(tmp == 2);
-        else if (i == 12) width += tmp;
-        else if (i == 13) width += 256*tmp;
-        else if (i == 14) height += tmp;
-        else if (i == 15) height += 256*tmp;
-        else if (i == 16) assert(tmp == 24);
-        else if (i == 17) assert(tmp == 32);
-        else assert(tmp == 0);
+    const unsigned char *pixels = ReadTGAHeader(file.data(), file.size(), width, height);
+    if (pixels == NULL) {
+        printf("Cannot read TGA image %s\n", filename);
+        return NULL;
     }
-    // the data
     Image *answer = new Image(width,height);
     // flip y so that (0,0) is bottom left corner
-    for (int y = height-1; y >= 0; y--) {
-        for (int x = 0; x < width; x++) {
-            unsigned char r,g,b;
-            // note reversed order: b, g, r
-            b = ReadByte(file);
-            g = ReadByte(file);
-            r = ReadByte(file);
-            Vector3f color(r/255.0,g/255.0,b/255.0);
-            answer->SetPixel(x,y,color);
-        }
+    #pragma omp parallel for schedule(static) if((size_t)width * height >= IMAGE_PARALLEL_TEXELS)
+    for (int y = 0; y < height; y++) {
+        const unsigned char *src = pixels + (size_t)3 * (height-1-y) * width;
+        Vector3f *dst = answer->data + (size_t)y * width;
+        // note reversed order: b, g, r
+        for (int x = 0; x < width; x++)
+            dst[x] = Vector3f(src[3*x+2], src[3*x+1], src[3*x]) * (Real)(1/255.0);
     }
-    fclose(file);
     return answer;
 }
 
-// Save and Load PPM image files using magic number 'P6' 
-// and having one comment line
+// Save and Load PPM image files using magic number 'P6'
+// (comments are allowed anywhere in the header)
 
 void Image::SavePPM(const char *filename) const {
     assert(filename != NULL);
@@ -142,40 +147,58 @@ void Image::SavePPM(const char *filename) const {
     fclose(file);
 }
 
+static void SkipPPMSpace(const char *&p, const char *end) {
+    while (p < end && (isspace((unsigned char)*p) || *p == '#')) {
+        if (*p == '#')
+            while (p < end && *p != '\n') p++;
+        else
+            p++;
+    }
+}
+
+static bool ReadPPMInt(const char *&p, const char *end, int &value) {
+    SkipPPMSpace(p, end);
+    if (p >= end || !isdigit((unsigned char)*p)) return false;
+    for (value = 0; p < end && isdigit((unsigned char)*p); p++)
+        value = value * 10 + (*p - '0');
+    return true;
+}
+
+const unsigned char *ReadPPMHeader(const char *data, size_t size, int &width, int &height) {
+    if (data == NULL || size < 2 || data[0] != 'P' || data[1] != '6') return NULL;
+    const char *p = data + 2, *end = data + size;
+    int maxval;
+    if (!ReadPPMInt(p, end, width) || !ReadPPMInt(p, end, height) || !ReadPPMInt(p, end, maxval))
+        return NULL;
+    // 8-bit samples only; a single whitespace separates the header from the data
+    if (maxval != 255 || p >= end || !isspace((unsigned char)*p)) return NULL;
+    p++;
+    if ((size_t)(end - p) < (size_t)3 * width * height) return NULL;
+    return (const unsigned char *)p;
+}
+
 Image* Image::LoadPPM(const char *filename) {
     assert(filename != NULL);
     // must end in .ppm
     const char *ext = &filename[strlen(filename)-4];
     assert(!strcmp(ext,".ppm"));
-    FILE *file = fopen(filename,"rb");
-    // misc header information
+    MappedFile file(filename);
     int width = 0;
-    int height = 0;  
-    char tmp[100];
-    fscanf(file, "%s", tmp); 
-    assert (strstr(tmp,"P6"));
-    //fgets(tmp,100,file); 
-    //assert (tmp[0] == '#');
-    fscanf(file, "%s", tmp);  //fgets(tmp,100,file); 
-    sscanf(tmp,"%d",&width);
-    fscanf(file, "%s", tmp);  //fgets(tmp,100,file); 
-    sscanf(tmp,"%d",&height);
-    fscanf(file, "%s", tmp);  //fgets(tmp,100,file); 
-    assert (strstr(tmp,"255"));
-    // the data
+    int height = 0;
+    const unsigned char *pixels = ReadPPMHeader(file.data(), file.size(), width, height);
+    if (pixels == NULL) {
+        printf("Cannot read PPM image %s\n", filename);
+        return NULL;
+    }
     Image *answer = new Image(width,height);
     // flip y so that (0,0) is bottom left corner
-    for (int y = height-1; y >= 0; y--) {
-        for (int x = 0; x < width; x++) {
-            unsigned char r,g,b;
-            b = fgetc(file);
-            r = fgetc(file);
-            g = fgetc(file);
-            Vector3f color(r/255.0,g/255.0,b/255.0);
-            answer->SetPixel(x,y,color);
-        }
+    #pragma omp parallel for schedule(static) if((size_t)width * height >= IMAGE_PARALLEL_TEXELS)
+    for (int y = 0; y < height; y++) {
+        const unsigned char *src = pixels + (size_t)3 * (height-1-y) * width;
+        Vector3f *dst = answer->data + (size_t)y * width;
+        for (int x = 0; x < width; x++)
+            dst[x] = Vector3f(src[3*x], src[3*x+1], src[3*x+2]) * (Real)(1/255.0);
     }
-    fclose(file);
     return answer;
 }
 
@@ -292,6 +315,46 @@ Image::SaveBMP(const char *filename)
     return(1);
 }
 
+// Read back the uncompressed 24-bit files written by SaveBMP.
+Image* Image::LoadBMP(const char *filename)
+{
+    assert(filename != NULL);
+    FILE *file = fopen(filename, "rb");
+    if (file == NULL) return NULL;
+
+    unsigned char header[54];
+    if (fread(header, 54, 1, file) != 1 || header[0] != 'B' || header[1] != 'M') {
+        fclose(file);
+        return NULL;
+    }
+    int offBits, width, height;
+    short bitCount;
+    memcpy(&offBits, header + 10, 4);
+    memcpy(&width, header + 18, 4);
+    memcpy(&height, header + 22, 4);
+    memcpy(&bitCount, header + 28, 2);
+    assert(bitCount == 24);
+    fseek(file, offBits, SEEK_SET);
+
+    int bytesPerLine = (3 * (width + 1) / 4) * 4;
+    unsigned char *line = (unsigned char *)malloc(bytesPerLine);
+    Image *answer = new Image(width, height);
+    // rows are stored bottom-up, which matches (0,0) being bottom left
+    for (int i = 0; i < height; i++)
+    {
+        int success = fread(line, bytesPerLine, 1, file);
+        assert(success == 1);
+        for (int j = 0; j < width; j++)
+        {
+            Vector3f color(line[3*j+2]/255.0, line[3*j+1]/255.0, line[3*j]/255.0);
+            answer->SetPixel(j, i, color);
+        }
+    }
+    free(line);
+    fclose(file);
+    return answer;
+}
+
 void Image::SaveImage(const char * filename)
 {
 	int len = strlen(filename);
@@ -0,0 +1,51 @@
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+
+#include "image.hpp"
+
+using namespace std;
+
+// Compare two renders of the same scene, e.g. the float and double builds.
+// Prints RMSE, mean absolute error and PSNR over all channels.
+int main(int argc, char *argv[]) {
+    if (argc != 3) {
+        cout << "Usage: ./bin/imgdiff <reference bmp file> <test bmp file>" << endl;
+        return 1;
+    }
+    Image *ref = Image::LoadBMP(argv[1]);
+    Image *img = Image::LoadBMP(argv[2]);
+    if (ref == NULL || img == NULL) {
+        cout << "cannot open input image" << endl;
+        return 1;
+    }
+    if (ref->Width() != img->Width() || ref->Height() != img->Height()) {
+        cout << "image sizes differ" << endl;
+        return 1;
+    }
+
+    double sqr = 0, abs = 0, maxErr = 0;
+    int W = ref->Width(), H = ref->Height();
+    for (int x = 0; x < W; ++x)
+        for (int y = 0; y < H; ++y) {
+            Vector3f d = ref->GetPixel(x, y) - img->GetPixel(x, y);
+            for (int c = 0; c < 3; ++c) {
+                sqr += d[c] * d[c];
+                abs += std::fabs(d[c]);
+                maxErr = std::max(maxErr, (double)std::fabs(d[c]));
+            }
+        }
+    double n = 3.0 * W * H;
+    double rmse = sqrt(sqr / n);
+    printf("RMSE: %.6lf\n", rmse);
+    printf("MAE: %.6lf\n", abs / n);
+    printf("Max: %.6lf\n", maxErr);
+    if (rmse > 0)
+        printf("PSNR: %.2lf dB\n", 20 * log10(1.0 / rmse));
+    else
+        printf("PSNR: inf\n");
+
+    delete ref;
+    delete img;
+    return 0;
+}
@@ -4,27 +4,59 @@
 #include <cstring>
 #include <cmath>
 #include <iostream>
+#include <atomic>
 
 #include "scene_parser.hpp"
 #include "image.hpp"
 #include "camera.hpp"
 #include "group.hpp"
 #include "light.hpp"
+#include "mesh.hpp"
 #include "hit.hpp"
 #include "photonmapping.hpp"
+#include "adaptive_sampler.hpp"
+#include "progress.hpp"
+#include "render_settings.hpp"
+#include "tile_scheduler.hpp"
+#include "wavefront.hpp"
+#include "mapped_file.hpp"
 
 #include <string>
 
 using namespace std;
 
+// FNV-1a over the scene file and the settings the photon maps and gathers
+// depend on, so baked irradiance is only reused under the same lighting.
+static uint64_t hashLighting(const char *sceneFile, const RenderSettings &settings) {
+    uint64_t h = 14695981039346656037ULL;
+    auto add = [&h](const void *data, size_t len) {
+        const unsigned char *p = (const unsigned char *)data;
+        for (size_t i = 0; i < len; ++i)
+            h = (h ^ p[i]) * 1099511628211ULL;
+    };
+    MappedFile scene(sceneFile);
+    if (scene.data() != NULL)
+        add(scene.data(), scene.size());
+    int values[] = {settings.emitPhoton, settings.maxInMap, settings.samplePhotons, settings.sampleDist,
+                    settings.causticPhotons, settings.directLighting, settings.finalGather,
+                    settings.gatherRays, settings.proxyTriangles, settings.aggregateGathers,
+                    settings.importance, settings.importanceParticles, settings.projectionMaps,
+                    settings.projectionRes, settings.sampler};
+    double reals[] = {settings.knnEpsilon, settings.causticKnnEpsilon, settings.aggregateTolerance,
+                      settings.importanceMinStore};
+    add(values, sizeof(values));
+    add(reals, sizeof(reals));
+    return h;
+}
+
 int main(int argc, char *argv[]) {
     //---------------------I/O--------------------------
     for (int argNum = 1; argNum < argc; ++argNum) {
         std::cout << "Argument " << argNum << " is: " << argv[argNum] << std::endl;
     }
 
-    if (argc != 3) {
-        cout << "Usage: ./bin/PA1 <input scene file> <output bmp file>" << endl;
+    if (argc < 3 || argc % 2 == 0) {
+        cout << "Usage: ./bin/PA1 <input scene file> <output bmp file> [<setting> <value> ...]" << endl;
         return 1;
     }
     string inputFile = argv[1];
@@ -33,40 +65,116 @@ int main(int argc, char *argv[]) {
 
     //-------------------Parameters---------------------
     SceneParser sceneParser(argv[1]);
-    int emitPhoton = 3000000;
-    int maxInMap = 10000000;
-    int sample_photons= 150000;
-	int sample_dist= 1;	
-    bool antialiasing = false;
-    double aliasing_samples[9][2] = {{-0.5,-0.5}, {-0.5,0}, {-0.5, 0.5}, {0,-0.5}, {0,0}, {0, 0.5}, {0.5,-0.5}, {0.5,0}, {0.5, 0.5}};
+    // command line settings override the Render block of the scene
+    RenderSettings &settings = sceneParser.getSettings();
+    for (int argNum = 3; argNum < argc; argNum += 2) {
+        if (!settings.set(argv[argNum], argv[argNum + 1])) {
+            cout << "Unknown setting " << argv[argNum] << " " << argv[argNum + 1] << endl;
+            return 1;
+        }
+    }
+    int emitPhoton = settings.emitPhoton;
+    int maxInMap = settings.maxInMap;
+    int sample_photons= settings.samplePhotons;
+	int sample_dist= settings.sampleDist;	
+    bool antialiasing = settings.antialiasing;
 
     // -------------------Build Map---------------------
     printf("Start building!!!\n");
 
+    Progress progress(settings.quiet, settings.progressInterval);
     PhotonMapping photonMapping(&sceneParser);
     photonMapping.map = new PhotonMap(emitPhoton, maxInMap, sample_photons, sample_dist);
-    double power = 0;
-    for (int li = 0; li < sceneParser.getNumLights(); ++li) {
-        Light* light = sceneParser.getLight(li);
-        power += light->getColorPower();
+    photonMapping.map->epsilon = settings.knnEpsilon;
+    photonMapping.progress = &progress;
+    // final gathering blurs the photons of caustic paths over the gather
+    // rays, so caustics are only seen through a caustic map
+    if (settings.finalGather && settings.causticPhotons == 0)
+        printf("Warning: finalGather without causticPhotons renders no caustics\n");
+    if (settings.causticPhotons > 0) {
+        photonMapping.causticMap = new PhotonMap(settings.causticPhotons, maxInMap, sample_photons, sample_dist);
+        photonMapping.causticMap->epsilon = settings.causticKnnEpsilon;
     }
-    double photon_power = power / emitPhoton;
-    int emited_photons = 0;
-    for (int li = 0 ; li < sceneParser.getNumLights(); ++li) {
-        Light* light = sceneParser.getLight(li);
-        // # photons is in proportional to light power
-        long iter = long(light->getColorPower()/photon_power);
-
-        #pragma omp parallel for schedule(dynamic, 1)
-        for (int i = 0; i <= iter; i ++){
-            // printf("%d\n", i);
-            emited_photons += 1;
-            Photon photon = sceneParser.getLight(li)->EmitPhoton();
-            photon.power *= power;
-            photonMapping.forwardTracing(photon, 1);
+    // final gathering samples direct light only from the lights that allow
+    // it; the first hits of photons from the others are looked up instead
+    bool unsampledLights = false;
+    for (int li = 0; li < sceneParser.getNumLights(); ++li)
+        unsampledLights = unsampledLights || !sceneParser.getLight(li)->canSampleDirect();
+    if (settings.finalGather && unsampledLights) {
+        photonMapping.unsampledMap = new PhotonMap(emitPhoton, std::min(emitPhoton, maxInMap), sample_photons, sample_dist);
+        photonMapping.unsampledMap->epsilon = settings.knnEpsilon;
+    }
+    if (settings.importance) {
+        Camera *camera = sceneParser.getCamera();
+        int particles = settings.importanceParticles > 0 ? settings.importanceParticles : 4 * camera->getWidth() * camera->getHeight();
+        photonMapping.importance = new ImportanceMap(sample_dist);
+        photonMapping.traceImportance(particles);
+        printf("Importance cells: %d\n", photonMapping.importance->numCells());
+        for (PhotonMap *m : {photonMapping.map, photonMapping.causticMap, photonMapping.unsampledMap})
+            if (m != NULL)
+                m->importance = photonMapping.importance, m->minStore = settings.importanceMinStore;
+    }
+    if (settings.projectionMaps || photonMapping.causticMap != NULL || photonMapping.importance != NULL)
+        photonMapping.buildProjectionMaps(settings.projectionRes);
+    std::vector<std::pair<Mesh*, Matrix4f> > meshes;
+    sceneParser.getGroup()->findMeshes(Matrix4f::identity(), meshes);
+    // only photons see the proxies; they are switched off before rendering
+    if (settings.proxyTriangles > 0)
+        for (size_t i = 0; i < meshes.size(); ++i) {
+            meshes[i].first->buildProxy(settings.proxyTriangles);
+            meshes[i].first->setProxy(true);
         }
+    progress.begin("photons", PROGRESS_PHOTONS, emitPhoton);
+    photonMapping.emitPhotons(emitPhoton, false);
+    progress.end();
+    if (photonMapping.causticMap != NULL) {
+        progress.begin("caustic photons", PROGRESS_PHOTONS, settings.causticPhotons);
+        photonMapping.emitPhotons(settings.causticPhotons, true);
+        progress.end();
+        printf("Stored caustic photons: %d\n", photonMapping.causticMap->stored_photons);
+        photonMapping.causticMap->buildKDTree();
+        if (settings.aggregateGathers)
+            photonMapping.causticMap->buildAggregates(settings.aggregateTolerance);
     }
+    for (size_t i = 0; i < meshes.size(); ++i)
+        meshes[i].first->setProxy(false);
+    printf("Stored photons: %d\n", photonMapping.map->stored_photons);
     photonMapping.map->buildKDTree();
+    if (settings.aggregateGathers)
+        photonMapping.map->buildAggregates(settings.aggregateTolerance);
+    if (photonMapping.unsampledMap != NULL) {
+        printf("Stored first-hit photons of lights without direct sampling: %d\n", photonMapping.unsampledMap->stored_photons);
+        if (photonMapping.unsampledMap->stored_photons == 0) {
+            delete photonMapping.unsampledMap;
+            photonMapping.unsampledMap = NULL;
+        }
+        else {
+            photonMapping.unsampledMap->buildKDTree();
+            if (settings.aggregateGathers)
+                photonMapping.unsampledMap->buildAggregates(settings.aggregateTolerance);
+        }
+    }
+    if (settings.finalGather && settings.cacheAccuracy > 0)
+        photonMapping.irradianceCache = new IrradianceCache(photonMapping.map->box_min, photonMapping.map->box_max, settings.cacheAccuracy);
+    if (settings.bakeIrradiance || settings.useBaked) {
+        uint64_t lighting = hashLighting(argv[1], settings);
+        for (size_t i = 0; i < meshes.size(); ++i) {
+            Mesh *mesh = meshes[i].first;
+            const Matrix4f &toWorld = meshes[i].second;
+            if (!settings.bakeIrradiance) {
+                if (mesh->loadBaked(toWorld, lighting))
+                    printf("Loaded baked irradiance %s\n", mesh->bakedFile(toWorld, lighting).c_str());
+                else
+                    printf("No baked irradiance for %s, gathering it at render time\n", mesh->getFile().c_str());
+                continue;
+            }
+            progress.begin("bake", PROGRESS_GATHERS, mesh->getVertices().size());
+            mesh->setBaked(photonMapping.bakeMesh(mesh, toWorld));
+            progress.end();
+            mesh->saveBaked(toWorld, lighting);
+            printf("Baked %d vertices into %s\n", (int)mesh->getVertices().size(), mesh->bakedFile(toWorld, lighting).c_str());
+        }
+    }
 
     printf("Build Finished!\n");
     // -------------------Rendering---------------------
@@ -75,75 +183,48 @@ int main(int argc, char *argv[]) {
     int W = camera->getWidth(), H = camera->getHeight();
     Image renderedImg(W, H);
 
-    Vector3f finalColor(0);
-    #pragma omp parallel for schedule(dynamic, 1) private(finalColor)
-    for (int x = 0; x < W; ++x) {
-        printf("%d\n", x);
-        for (int y = 0; y < H; ++y) {
-            if(((x+1)%80) == 0 && ((y+1)%100) == 0)
-                printf("%d %d\n", x, y);
-            // printf("%d %d\n", x, y);
-            Ray camRay = camera->generateRay(Vector2f(x, y));
-
-            if (!camera->isDOF){
-                finalColor = photonMapping.backwardTracing(camRay, 1);
-                renderedImg.SetPixel(x, y, finalColor);
-            }
-            else{
-                finalColor = Vector3f(0);
-                Vector3f camCenter = camera->center;
-                Vector3f focusPoint = camRay.pointAtParameter(camera->focusDist);
-                Vector3f dirX = Vector3f::cross(camera->direction, camera->up).normalized();
-                Vector3f dirY = Vector3f::cross(camera->direction, dirX).normalized();
-                for (int i = 0; i < camera->lenSampleNum; ++i) {
-                    // modify the ray for DOF
-                    double dx=( ran() * 2 - 1 ), dy = ( ran() * 2 - 1 ), square = dx*dx+dy*dy;
-                    dx /= sqrt(square), dy /= sqrt(square);
-                    Vector3f newO = camCenter + camera->lenRadius*dx*dirX + camera->lenRadius*dy*dirY; // lenRadius: lens aperture
-                    Ray newRay = Ray(newO, (focusPoint-newO).normalized());
-                    finalColor += photonMapping.backwardTracing(newRay, 1);
-                }
-                renderedImg.SetPixel(x, y, finalColor/camera->lenSampleNum);
-            }
+    // tiles are shared by the render and anti-aliasing passes
+    TileScheduler scheduler(W, H, settings.tileSize, settings.tileOrder);
+    AdaptiveSampler sampler(camera, &photonMapping, settings);
+    progress.begin("render", PROGRESS_PIXELS, (uint64_t)W * H);
+    scheduler.run([&](const Tile &tile) {
+        if (settings.wavefront || settings.sortGathers) {
+            Wavefront wavefront(&photonMapping);
+            sampler.initialBatch(tile.x0, tile.y0, tile.x1, tile.y1, wavefront);
+            progress.add(PROGRESS_PIXELS, (tile.x1 - tile.x0) * (tile.y1 - tile.y0));
+            return;
         }
-    }
-    // Post-Processing: Anti-Aliasing
-    int Cnt = 0;
+        for (int x = tile.x0; x < tile.x1; ++x) {
+            for (int y = tile.y0; y < tile.y1; ++y)
+                sampler.initial(x, y);
+            progress.add(PROGRESS_PIXELS, tile.y1 - tile.y0);
+        }
+    });
+    progress.end();
+    if (photonMapping.irradianceCache != NULL)
+        printf("Irradiance cache records: %d\n", photonMapping.irradianceCache->numRecords());
+    // Post-Processing: adaptive Anti-Aliasing
     if (antialiasing) {
-        double thres = 0.3;
-        double** G = new double*[W+2];
-        for(int i = 0; i < W+2; ++i)
-            G[i] = new double[H+2];
-        for(int x = 1; x < W+1; ++x) 
-            for(int y = 1; y < H+1; ++y)
-                G[x][y] = renderedImg.GetPixel(x-1, y-1).avg();
-
-        #pragma omp parallel for schedule(dynamic, 1) private(finalColor)
-        for(int x = 1; x < W+1; ++x) {
-            printf("%d\n", x);
-            for(int y = 1; y < H+1; ++y) {
-                double Gx = G[x-1][y+1]+2*G[x][y+1]+G[x+1][y+1]-G[x-1][y-1]-2*G[x][y-1]-G[x+1][y-1];
-                double Gy = G[x-1][y-1]+2*G[x-1][y]+G[x-1][y+1]-G[x+1][y-1]-2*G[x+1][y]-G[x+1][y+1];
-                if(Gx*Gx + Gy*Gy > thres) {
-                    // Anti-aliasing without DOF !!!!!
-                    Cnt ++;
-                    finalColor = Vector3f(0);
-                    for(int k = 0; k < 9; ++k) {
-                        Ray camRay = camera->generateRay(Vector2f(x-1+aliasing_samples[k][0], y-1+aliasing_samples[k][1]));
-                        if (!camera->isDOF)
-                            finalColor += photonMapping.backwardTracing(camRay, 1);
+        sampler.finishInitial();
+        std::atomic<int> refined(0);
+        std::atomic<long> extraSamples(0);
+        progress.begin("antialiasing", PROGRESS_PIXELS, (uint64_t)W * H);
+        scheduler.run([&](const Tile &tile) {
+            for (int x = tile.x0; x < tile.x1; ++x) {
+                for (int y = tile.y0; y < tile.y1; ++y) {
+                    int added = sampler.refine(x, y);
+                    if (added > 0) {
+                        refined++;
+                        extraSamples += added;
                     }
-                    finalColor = finalColor / 9.0;
-                    renderedImg.SetPixel(x-1, y-1, finalColor);
                 }
+                progress.add(PROGRESS_PIXELS, tile.y1 - tile.y0);
             }
-        }
-        for(int i = 0; i < W+2; ++i)
-            delete[] G[i];
-        delete[] G;
+        });
+        progress.end();
+        printf("Anti-aliased pixels: %d, %ld extra samples\n", refined.load(), extraSamples.load());
     }
-    
-    printf("%d\n", Cnt);
+    sampler.resolve(renderedImg);
     renderedImg.SaveImage(argv[2]);
     return 0;
 }
@@ -1,202 +1,370 @@
 #include "mesh.hpp"
-#include <fstream>
 #include <iostream>
 #include <algorithm>
 #include <cstdlib>
 #include <utility>
-#include <sstream>
+#include <vector>
+#include <cstring>
+#include <cstdio>
+#include "mapped_file.hpp"
+#include "mesh_io.hpp"
+#include "mesh_simplify.hpp"
 
 #define EPS 1e-7
 
-void Mesh::getMtlSize(std::string file) {
-	std::ifstream fin(file.c_str());
-	std::string order;
+// ------------------- kd-tree cache -------------------
+// header | nodes in preorder | triangle ids of the leaves
 
-	while (getline(fin, order, '\n')) {
-		std::stringstream fin2(order);
-		std::string var;
-		if (!(fin2 >> var)) continue;
-		if (var == "newmtl")
-			matSize++;
+struct TreeCacheHeader {
+	char magic[4];
+	int version, realSize;
+	int triCnt, nodeCnt, refCnt;
+	uint64_t hash;
+};
+
+struct TreeCacheNode {
+	Real minPos[3], maxPos[3];
+	Real split;
+	int plane, ls, rs;
+	int first, size;
+};
+
+// FNV-1a over the OBJ contents and everything else the tree depends on.
+static uint64_t hashBytes(uint64_t h, const void *data, size_t len) {
+	const unsigned char *p = (const unsigned char *)data;
+	for (size_t i = 0; i < len; ++i)
+		h = (h ^ p[i]) * 1099511628211ULL;
+	return h;
+}
+
+static uint64_t hashMesh(const char *data, size_t size, Real scale) {
+	uint64_t h = 14695981039346656037ULL;
+	h = hashBytes(h, data, size);
+	int version = TRI_TREE_VERSION, realSize = sizeof(Real);
+	double epsilon = EPS;
+	h = hashBytes(h, &scale, sizeof(scale));
+	h = hashBytes(h, &version, sizeof(version));
+	h = hashBytes(h, &realSize, sizeof(realSize));
+	h = hashBytes(h, &epsilon, sizeof(epsilon));
+	return h;
+}
+
+static void flattenTree(TriTreeNode* node, std::vector<TreeCacheNode> &nodes, std::vector<int> &refs) {
+	int idx = nodes.size();
+	nodes.push_back(TreeCacheNode());
+	TreeCacheNode c;
+	for (int i = 0; i < 3; ++i)
+		c.minPos[i] = node->box.minPos[i], c.maxPos[i] = node->box.maxPos[i];
+	c.split = node->split;
+	c.plane = node->plane;
+	c.ls = c.rs = -1;
+	c.first = refs.size();
+	c.size = 0;
+	if (node->ls == NULL && node->rs == NULL) {
+		c.size = node->size;
+		for (int i = 0; i < node->size; ++i)
+			refs.push_back(node->triangleList[i]->id);
+	}
+	if (node->ls != NULL) {
+		c.ls = nodes.size();
+		flattenTree(node->ls, nodes, refs);
+	}
+	if (node->rs != NULL) {
+		c.rs = nodes.size();
+		flattenTree(node->rs, nodes, refs);
 	}
-	fin.close();
-	mat = new Material*[matSize + 1];
-	mat[0] = new Material;
+	nodes[idx] = c;
 }
 
-void Mesh::getSize(std::string file) {
-	std::ifstream fin(file.c_str());
-	std::string order;
-	
-	while (getline(fin, order, '\n')) {
-		std::stringstream fin2(order);
-		std::string var;
-		if (!(fin2 >> var)) continue;
-		if (var == "mtllib") {
-			std::string mtlFile;
-			fin2 >> mtlFile;
-			getMtlSize(mtlFile);
-		}
-		if (var == "v")
-			vSize++;
-		if (var == "vt")
-			vtSize++;
-		if (var == "vn")
-			vnSize++;
-		if (var == "f") {
-			int vertexCnt = 0;
-			std::string var;
-			while (fin2 >> var)
-				vertexCnt++;
-			fSize += std::max(0, vertexCnt - 2);
-		}
+void TriangleTree::saveCache(const std::string &file, uint64_t hash, int triCnt) {
+	std::vector<TreeCacheNode> nodes;
+	std::vector<int> refs;
+	flattenTree(root, nodes, refs);
+
+	TreeCacheHeader header;
+	memcpy(header.magic, "TTRC", 4);
+	header.version = TRI_TREE_VERSION;
+	header.realSize = sizeof(Real);
+	header.triCnt = triCnt;
+	header.nodeCnt = nodes.size();
+	header.refCnt = refs.size();
+	header.hash = hash;
+
+	FILE *fp = fopen(file.c_str(), "wb");
+	if (fp == NULL) {
+		printf("Cannot write kd-tree cache %s\n", file.c_str());
+		return;
 	}
-	fin.close();
-	v = new Vector3f[vSize + 1];
-	vt = new std::pair<double, double>[vtSize + 1];
-	if (vnSize == 0)
-		vn = new Vector3f[vSize + 1];
-	else
-		vn = new Vector3f[vnSize + 1];
-	triangleList = new Triangle*[fSize];
+	fwrite(&header, sizeof(header), 1, fp);
+	fwrite(nodes.data(), sizeof(TreeCacheNode), nodes.size(), fp);
+	if (!refs.empty())
+		fwrite(refs.data(), sizeof(int), refs.size(), fp);
+	fclose(fp);
+}
+
+bool TriangleTree::loadCache(const std::string &file, uint64_t hash, Triangle** triangles, int triCnt) {
+	MappedFile mapped(file.c_str());
+	size_t fileSize = mapped.size();
+	if (mapped.data() == NULL || fileSize < sizeof(TreeCacheHeader))
+		return false;
+
+	const TreeCacheHeader *header = (const TreeCacheHeader *)mapped.data();
+	const TreeCacheNode *cached = (const TreeCacheNode *)(header + 1);
+	const int *refs = (const int *)(cached + (header->nodeCnt > 0 ? header->nodeCnt : 0));
+	bool valid = memcmp(header->magic, "TTRC", 4) == 0 && header->version == TRI_TREE_VERSION
+		&& header->realSize == (int)sizeof(Real) && header->hash == hash && header->triCnt == triCnt
+		&& header->nodeCnt > 0 && header->refCnt >= 0
+		&& fileSize == sizeof(TreeCacheHeader) + header->nodeCnt * sizeof(TreeCacheNode) + header->refCnt * sizeof(int);
+	for (int i = 0; valid && i < header->nodeCnt; ++i) {
+		const TreeCacheNode &c = cached[i];
+		// children always come after their parent in preorder
+		valid = (c.ls == -1 || (c.ls > i && c.ls < header->nodeCnt))
+			&& (c.rs == -1 || (c.rs > i && c.rs < header->nodeCnt))
+			&& c.first >= 0 && c.size >= 0 && c.first + c.size <= header->refCnt;
+	}
+	for (int i = 0; valid && i < header->refCnt; ++i)
+		valid = refs[i] >= 0 && refs[i] < triCnt;
+	if (!valid)
+		return false;
+
+	std::vector<TriTreeNode*> nodes(header->nodeCnt);
+	for (int i = 0; i < header->nodeCnt; ++i)
+		nodes[i] = new TriTreeNode;
+	for (int i = 0; i < header->nodeCnt; ++i) {
+		const TreeCacheNode &c = cached[i];
+		TriTreeNode *node = nodes[i];
+		for (int k = 0; k < 3; ++k)
+			node->box.minPos[k] = c.minPos[k], node->box.maxPos[k] = c.maxPos[k];
+		node->split = c.split;
+		node->plane = c.plane;
+		node->size = c.size;
+		node->triangleList = new Triangle*[c.size];
+		for (int k = 0; k < c.size; ++k)
+			node->triangleList[k] = triangles[refs[c.first + k]];
+		node->ls = c.ls == -1 ? NULL : nodes[c.ls];
+		node->rs = c.rs == -1 ? NULL : nodes[c.rs];
+	}
+	delete root;
+	root = nodes[0];
+	return true;
 }
 
-void Mesh::getMtl(std::string file) {
-	std::ifstream fin(file.c_str());
-	std::string order;
-	int matCnt = 0;
-	while (getline(fin, order, '\n')) {
-		std::stringstream fin2(order);
-		std::string var;
-		if (!(fin2 >> var)) continue;
-
-		if (var == "newmtl") {
-			std::string matName;
-			fin2 >> matName;
-			matMap[matName] = ++matCnt;
-			mat[matCnt] = new Material();
+// ------------------- baked irradiance -------------------
+// header | two float triples per vertex
+
+struct BakedHeader {
+	char magic[4];
+	int version, vertexCnt;
+	uint64_t hash, lighting;
+};
+
+static uint64_t hashPlacement(uint64_t hash, const Matrix4f &toWorld) {
+	float m[16];
+	for (int i = 0; i < 16; ++i)
+		m[i] = toWorld(i % 4, i / 4);
+	return hashBytes(hash, m, sizeof(m));
+}
+
+std::string Mesh::bakedFile(const Matrix4f &toWorld, uint64_t lighting) const {
+	char suffix[32];
+	uint64_t key = hashBytes(hashPlacement(hash, toWorld), &lighting, sizeof(lighting));
+	snprintf(suffix, sizeof(suffix), ".%016llx.irr", (unsigned long long)key);
+	return file + suffix;
+}
+
+void Mesh::setBaked(const std::vector<Vector3f> &irradiance) {
+	if (irradiance.size() != 2 * vertices.size()) return;
+	baked = irradiance;
+	for (size_t i = 0; i < triangleList.size(); ++i)
+		triangleList[i]->baked = baked.data();
+}
+
+void Mesh::saveBaked(const Matrix4f &toWorld, uint64_t lighting) const {
+	std::string name = bakedFile(toWorld, lighting);
+	BakedHeader header;
+	memcpy(header.magic, "IRRB", 4);
+	header.version = BAKED_IRRADIANCE_VERSION;
+	header.vertexCnt = vertices.size();
+	header.hash = hashPlacement(hash, toWorld);
+	header.lighting = lighting;
+	std::vector<float> values(baked.size() * 3);
+	for (size_t i = 0; i < baked.size(); ++i)
+		for (int c = 0; c < 3; ++c)
+			values[3 * i + c] = baked[i][c];
+
+	FILE *fp = fopen(name.c_str(), "wb");
+	if (fp == NULL) {
+		printf("Cannot write baked irradiance %s\n", name.c_str());
+		return;
+	}
+	fwrite(&header, sizeof(header), 1, fp);
+	if (!values.empty())
+		fwrite(values.data(), sizeof(float), values.size(), fp);
+	fclose(fp);
+}
+
+bool Mesh::loadBaked(const Matrix4f &toWorld, uint64_t lighting) {
+	MappedFile mapped(bakedFile(toWorld, lighting).c_str());
+	size_t fileSize = mapped.size();
+	if (mapped.data() == NULL || fileSize < sizeof(BakedHeader))
+		return false;
+	const BakedHeader *header = (const BakedHeader *)mapped.data();
+	if (memcmp(header->magic, "IRRB", 4) != 0 || header->version != BAKED_IRRADIANCE_VERSION
+		|| header->hash != hashPlacement(hash, toWorld) || header->lighting != lighting || header->vertexCnt != (int)vertices.size()
+		|| fileSize != sizeof(BakedHeader) + header->vertexCnt * 6 * sizeof(float))
+		return false;
+	const float *values = (const float *)(header + 1);
+	std::vector<Vector3f> irradiance(2 * vertices.size());
+	for (size_t i = 0; i < irradiance.size(); ++i)
+		irradiance[i] = Vector3f(values[3 * i], values[3 * i + 1], values[3 * i + 2]);
+	setBaked(irradiance);
+	return true;
+}
+
+void Mesh::computeNormal() {
+	vertexNormals.assign(vertices.size(), Vector3f(0));
+	for (size_t i = 0; i < triangleList.size(); ++i) {
+		const Triangle *tri = triangleList[i];
+		// oriented like Triangle::setpar; the cross product is twice the
+		// area, so larger faces weigh more
+		Vector3f n = Vector3f::cross(tri->vertices[2] - tri->vertices[0], tri->vertices[1] - tri->vertices[0]);
+		for (int j = 0; j < 3; ++j)
+			if (tri->vertexID[j] >= 0)
+				vertexNormals[tri->vertexID[j]] += n;
+	}
+	for (size_t i = 0; i < vertexNormals.size(); ++i)
+		if (vertexNormals[i].length() > 0)
+			vertexNormals[i].normalize();
+}
+
+// ------------------- Mesh loading -------------------
+// Geometry comes from a text OBJ or a binary mesh (see mesh_io.hpp); both
+// are memory-mapped and recognized by content, not by extension.
+
+void Mesh::parseMtl(const std::string &file) {
+	MappedFile mapped(file.c_str());
+	if (mapped.data() == NULL) {
+		printf("Cannot open material library %s\n", file.c_str());
+		return;
+	}
+	if (mat.empty())
+		mat.push_back(new Material);
+	const char *end = mapped.data() + mapped.size();
+	Material *cur = mat[0];
+	for (const char *line = mapped.data(); line < end; line = nextLine(line, end)) {
+		const char *q = line;
+		skipBlank(q, end);
+		if (q >= end || *q == '#' || *q == '\n') continue;
+
+		if (isKeyword(q, end, "newmtl", 6)) {
+			q += 6;
+			matMap[parseWord(q, end)] = mat.size();
+			cur = new Material();
+			mat.push_back(cur);
 		}
-		if (var == "Kd") {
-            Vector3f color(0);
-            fin2 >> color[0] >> color[1] >> color[2];
-			mat[matCnt]->mColor = color;
-			mat[matCnt]->diffusion = std::max(mat[matCnt]->mColor[0], std::max(mat[matCnt]->mColor[1], mat[matCnt]->mColor[2]));
-			mat[matCnt]->mColor = mat[matCnt]->mColor/mat[matCnt]->diffusion;
+		else if (isKeyword(q, end, "Kd", 2)) {
+			q += 2;
+			Vector3f color(0);
+			parseReal(q, end, color[0]), parseReal(q, end, color[1]), parseReal(q, end, color[2]);
+			cur->mColor = color;
+			cur->diffusion = std::max(cur->mColor[0], std::max(cur->mColor[1], cur->mColor[2]));
+			cur->mColor = cur->mColor/cur->diffusion;
 		}
-		if (var == "Ks") {
-			fin2 >> mat[matCnt]->reflection;
+		else if (isKeyword(q, end, "Ks", 2)) {
+			q += 2;
+			parseReal(q, end, cur->reflection);
 		}
-		if (var == "Tf") {
-            Vector3f absorb(0);
-            fin2 >> absorb[0] >> absorb[1] >> absorb[2];
-			mat[matCnt]->absorption = absorb;
-			if ((mat[matCnt]->absorption[0]+mat[matCnt]->absorption[1]+mat[matCnt]->absorption[2])/3.0 < 1 - EPS) {
-				mat[matCnt]->refraction = 1;
+		else if (isKeyword(q, end, "Tf", 2)) {
+			q += 2;
+			Vector3f absorb(0);
+			parseReal(q, end, absorb[0]), parseReal(q, end, absorb[1]), parseReal(q, end, absorb[2]);
+			cur->absorption = absorb;
+			if ((cur->absorption[0]+cur->absorption[1]+cur->absorption[2])/3.0 < 1 - EPS) {
+				cur->refraction = 1;
 			}
 		}
-		if (var == "Ni") {
-			fin2 >> mat[matCnt]->refractionN;
+		else if (isKeyword(q, end, "Ni", 2)) {
+			q += 2;
+			parseReal(q, end, cur->refractionN);
 		}
 	}
-	fin.close();
 }
 
-Mesh::Mesh(const char *filename, Material *material, double scale) : Object3D(material) {
+Mesh::Mesh(const char *filename, Material *material, Real scale) : Object3D(material) {
 	this->scale = scale;
-    vSize = vtSize = vnSize = fSize = matSize = 0;
     tree = new TriangleTree;
-    std::string file = std::string(filename);
-    getSize(file);
-	std::ifstream fin(file.c_str());
-	std::string order;
-
-	int matID = -1;
-	int vCnt = 0, vtCnt = 0, vnCnt = 0, fCnt = 0;
-	while (getline(fin, order, '\n')) {
-		std::stringstream fin2(order);
-		std::string var;
-		if (!(fin2 >> var)) continue;
-
-		if (var == "mtllib") {
-			std::string mtlFile;
-			fin2 >> mtlFile;
-			getMtl(mtlFile);
+    file = std::string(filename);
+	MappedFile mapped(filename);
+	if (mapped.data() == NULL)
+		printf("Cannot open mesh %s\n", filename);
+	MeshData data;
+	if (isBinaryMesh(mapped.data(), mapped.size())) {
+		if (!loadBinaryMesh(mapped.data(), mapped.size(), data)) {
+			// left empty: no triangles, so nothing is hit
+			printf("Cannot load binary mesh %s\n", filename);
+			hash = 0;
+			return;
 		}
+	}
+	else
+		parseObj(mapped.data(), mapped.size(), data);
+	for (size_t i = 0; i < data.mtllibs.size(); ++i)
+		parseMtl(data.mtllibs[i]);
+	std::vector<int> mtlIds(data.mtlNames.size());
+	for (size_t i = 0; i < mtlIds.size(); ++i) {
+		std::map<std::string, int>::iterator it = matMap.find(data.mtlNames[i]);
+		mtlIds[i] = it != matMap.end() ? it->second : (mat.empty() ? -1 : 0);
+	}
+	const std::vector<Vector3f> &v = data.v;
+	const std::vector<MeshFace> &faces = data.faces;
 
-		if (var == "usemtl") {
-			std::string matName;
-			fin2 >> matName;
-			matID = matMap[matName];
-		}
-		if (var == "v") {
-			vCnt++;
-			v[vCnt].Input(fin2);
-		}
-		if (var == "vt") {
-			vtCnt++;
-			fin2 >> vt[vtCnt].second >> vt[vtCnt].first;
-		}
-		if (var == "vn") {
-			vnCnt++;
-			vn[vnCnt].Input(fin2);
-		}
-		if (var == "f") {
-			Triangle* tri = triangleList[fCnt] = new Triangle(NULL);
-			if (matID != -1)
-				tri->material = mat[matID];
-			else
-				tri->material = this->material;
-			std::string str;
-			for (int i = 0; fin2 >> str; ++i) {
-				int bufferLen = 0, buffer[3];
-				buffer[0] = buffer[1] = buffer[2] = -1;
-				for (int s = 0, t = 0; t < (int)str.length(); ++t)
-					if (t + 1 >= (int)str.length() || str[t + 1] == '/') {
-						buffer[bufferLen++] = atoi(str.substr(s, t - s + 1).c_str());
-						s = t + 2;
-					}
-				int j = i;
-				if (i >= 3) {
-					j = 2;
-					tri = triangleList[fCnt] = new Triangle(NULL);
-					*tri = *triangleList[fCnt - 1];
-					tri->vertices[1] = tri->vertices[2];
-					tri->textureVertex[1] = tri->textureVertex[2];
-					tri->normalVectorID[1] = tri->normalVectorID[2];
-				}
-				if (buffer[0] > 0) {
-					Vector3f p = v[buffer[0]];
-                    p *= 1/this->scale;
-                    if (j == 0) tri->vertices[0] = p;
-                    else if (j == 1) tri->vertices[1] = p;
-                    else if (j == 2) tri->vertices[2] = p;
-				}
-				if (buffer[1] > 0)
-					tri->textureVertex[j] = buffer[1];
-				if (buffer[2] > 0)
-					tri->normalVectorID[j] = buffer[2];
-				if (i >= 2)
-					tri->setpar(), fCnt++;
+	int vCnt = v.size() - 1, vtCnt = data.vt.size() - 1, vnCnt = data.vn.size() - 1, fCnt = faces.size();
+	vertices.resize(std::max(vCnt, 0));
+	for (int i = 0; i < vCnt; ++i)
+		vertices[i] = v[i + 1] * (1 / this->scale);
+	triangleList.resize(fCnt);
+	for (int i = 0; i < fCnt; ++i) {
+		const MeshFace &face = faces[i];
+		Triangle* tri = triangleList[i] = new Triangle(NULL);
+		if (face.mtl != -1 && mtlIds[face.mtl] != -1)
+			tri->material = mat[mtlIds[face.mtl]];
+		else
+			tri->material = this->material;
+		for (int j = 0; j < 3; ++j) {
+			if (face.v[j] > 0 && face.v[j] <= vCnt) {
+				tri->vertices[j] = vertices[face.v[j] - 1];
+				tri->vertexID[j] = face.v[j] - 1;
 			}
+			tri->textureVertex[j] = face.vt[j];
+			tri->normalVectorID[j] = face.vn[j];
 		}
+		tri->setpar();
+		tri->id = i;
 	}
-	fin.close();
+	computeNormal();
 
-	TriTreeNode* root = tree->root;
-	root->size = fCnt;
-	root->triangleList = new Triangle*[root->size];
-	// for(int i = 0; i < fCnt; ++ i)
-	// 	triangleList[i]->print();
-	for (int i = 0; i < root->size; ++i) {
-		root->triangleList[i] = triangleList[i];
-		root->box.UpdateBox(triangleList[i]);
+	// reuse the kd-tree from a previous run if mesh and builder are unchanged
+	std::string cacheFile = file + ".tree";
+	hash = hashMesh(mapped.data(), mapped.size(), this->scale);
+	if (tree->loadCache(cacheFile, hash, triangleList.data(), fCnt)) {
+		printf("Loaded kd-tree cache %s\n", cacheFile.c_str());
+	}
+	else {
+		TriTreeNode* root = tree->root;
+		root->size = fCnt;
+		root->triangleList = new Triangle*[root->size];
+		for (int i = 0; i < root->size; ++i) {
+			root->triangleList[i] = triangleList[i];
+			root->box.UpdateBox(triangleList[i]);
+		}
+		tree->buildTree();
+		tree->saveCache(cacheFile, hash, fCnt);
 	}
-	tree->buildTree();
-    printf("vCnt: %d, vtCnt: %d, vnCnt: %d, fCnt: %d, rootSize: %d\n", vCnt, vtCnt, vnCnt, fCnt, root->size);
+    printf("vCnt: %d, vtCnt: %d, vnCnt: %d, fCnt: %d\n", vCnt, vtCnt, vnCnt, fCnt);
 }
 
 void TriangleTree::sortList(Triangle** triangleList, int left, int right, int idx, bool isMin) {
-	double (Triangle::*GetCoord)(int) = isMin ? &Triangle::MinCoord : &Triangle::MaxCoord;
+	Real (Triangle::*GetCoord)(int) = isMin ? &Triangle::MinCoord : &Triangle::MaxCoord;
 	if (left >= right) return;
 	Triangle* key = triangleList[(left + right) >> 1];
 	int i,j;
@@ -218,10 +386,10 @@ void TriangleTree::build(TriTreeNode* node) {
 	for (int i = 0; i < node->size; ++i)
 		minNode[i] = node->triangleList[i], maxNode[i] = node->triangleList[i];
 	
-	double thisCost = node->box.GetArea() * (node->size - 1);
-	double mncost = thisCost;
+	Real thisCost = node->box.GetArea() * (node->size - 1);
+	Real mncost = thisCost;
 	int bestc = -1, leftSize = 0, rightSize = 0;
-	double bests = 0;
+	Real bests = 0;
 	for (int idx = 0; idx < 3; ++idx) {
 		sortList(minNode, 0, node->size-1, idx, true);
 		sortList(maxNode, 0, node->size-1, idx, false);
@@ -229,11 +397,11 @@ void TriangleTree::build(TriTreeNode* node) {
 		BoundBox rightBox = node->box;
 
 		for (int i = 0, j = 0; i < node->size; ++i) {
-			double split = minNode[i]->MinCoord(idx);
+			Real split = minNode[i]->MinCoord(idx);
 			leftBox.maxPos[idx] = split;
 			rightBox.minPos[idx] = split;
 			for ( ; j < node->size && maxNode[j]->MaxCoord(idx) <= split + EPS; ++j);
-			double cost = leftBox.GetArea() * i + rightBox.GetArea() * (node->size - j);
+			Real cost = leftBox.GetArea() * i + rightBox.GetArea() * (node->size - j);
 			if (cost < mncost) {
 				mncost = cost, bestc = idx, bests = split;
 				leftSize = i;
@@ -242,11 +410,11 @@ void TriangleTree::build(TriTreeNode* node) {
 		}
 
 		for (int i = 0, j = 0; i < node->size; ++i) {
-			double split = maxNode[i]->MaxCoord(idx);
+			Real split = maxNode[i]->MaxCoord(idx);
 			leftBox.maxPos[idx] = split;
 			rightBox.minPos[idx] = split;
 			for ( ; j < node->size && minNode[j]->MinCoord(idx) <= split - EPS; ++j);
-			double cost = leftBox.GetArea() * j + rightBox.GetArea() * (node->size - i);
+			Real cost = leftBox.GetArea() * j + rightBox.GetArea() * (node->size - i);
 			if (cost < mncost) {
 				mncost = cost, bestc = idx, bests = split;
 				leftSize = j;
@@ -270,7 +438,7 @@ void TriangleTree::build(TriTreeNode* node) {
 	BoundBox leftBox = node->box, rightBox = node->box;
 	leftBox.maxPos[bestc] = rightBox.minPos[bestc] = bests;
 	// *****
-	double cost = leftBox.GetArea() * leftSize + rightBox.GetArea() * rightSize;
+	Real cost = leftBox.GetArea() * leftSize + rightBox.GetArea() * rightSize;
 
 	if (cost < thisCost) {
 		node->plane = bestc, node->split = bests;
@@ -300,7 +468,7 @@ void TriangleTree::build(TriTreeNode* node) {
 	}
 }
 
-bool TriangleTree::searchTree(TriTreeNode* node, const Ray &r, Hit &h, double tmin){
+bool TriangleTree::searchTree(TriTreeNode* node, const Ray &r, Hit &h, Real tmin){
     Vector3f ray_O = r.getOrigin(), ray_V = r.getDirection();
 	if (!(node->box.InBox(ray_O)) && node->box.intersect(r) <= -EPS)
 		return false;
@@ -313,7 +481,7 @@ bool TriangleTree::searchTree(TriTreeNode* node, const Ray &r, Hit &h, double tm
 			flag = node->triangleList[i]->intersect(r, triHit, tmin);
 			// if(flag) node->triangleList[i]->print(); 
 			if (flag) {
-				if( node->box.InBox(r.pointAtParameter(triHit.getT())) && (!treeIntersect || triHit.getT() < h.getT()))
+				if( node->box.InBox(r.pointAtParameter(triHit.getT())) && triHit.getT() < h.getT())
 					h = triHit, treeIntersect = true;
             }
 		}
@@ -329,8 +497,8 @@ bool TriangleTree::searchTree(TriTreeNode* node, const Ray &r, Hit &h, double tm
 		return searchTree(node->ls, r, h, tmin);
 	}
 
-	double leftDist = node->ls->box.intersect(r);
-	double rightDist = node->rs->box.intersect(r);
+	Real leftDist = node->ls->box.intersect(r);
+	Real rightDist = node->rs->box.intersect(r);
 	if (rightDist <= -EPS)
 		return searchTree(node->ls, r, h, tmin);
 	if (leftDist <= -EPS)
@@ -346,6 +514,50 @@ bool TriangleTree::searchTree(TriTreeNode* node, const Ray &r, Hit &h, double tm
 	}
 }
 
-bool Mesh::intersect(const Ray &r, Hit &h, double tmin) {
+bool Mesh::intersect(const Ray &r, Hit &h, Real tmin) {
+	if (proxyActive)
+		return proxyTree->intersect(r, h, tmin);
     return tree->intersect(r, h, tmin);
+}
+
+// ------------------- photon proxy -------------------
+
+void Mesh::buildProxy(int target) {
+	if (proxyTree != NULL || (int)triangleList.size() <= target) return;
+	// faceTriangle maps the faces handed to simplifyMesh back to triangleList
+	std::vector<int> indices, sources, faceTriangle;
+	for (size_t i = 0; i < triangleList.size(); ++i) {
+		const Triangle *tri = triangleList[i];
+		if (tri->material->reflection > EPS || tri->material->refraction > EPS) {
+			printf("Mesh %s is not purely diffuse, photons trace the full mesh\n", file.c_str());
+			return;
+		}
+		if (tri->vertexID[0] < 0 || tri->vertexID[1] < 0 || tri->vertexID[2] < 0) continue;
+		for (int j = 0; j < 3; ++j)
+			indices.push_back(tri->vertexID[j]);
+		faceTriangle.push_back(i);
+	}
+	std::vector<Vector3f> positions = vertices;
+	simplifyMesh(positions, indices, sources, target);
+
+	proxyList.resize(sources.size());
+	for (size_t i = 0; i < sources.size(); ++i) {
+		Triangle* tri = proxyList[i] = new Triangle(triangleList[faceTriangle[sources[i]]]->material);
+		for (int j = 0; j < 3; ++j) {
+			tri->vertices[j] = positions[indices[3 * i + j]];
+			tri->textureVertex[j] = tri->normalVectorID[j] = -1;
+		}
+		tri->setpar();
+		tri->id = i;
+	}
+	proxyTree = new TriangleTree;
+	TriTreeNode* root = proxyTree->root;
+	root->size = proxyList.size();
+	root->triangleList = new Triangle*[root->size];
+	for (int i = 0; i < root->size; ++i) {
+		root->triangleList[i] = proxyList[i];
+		root->box.UpdateBox(proxyList[i]);
+	}
+	proxyTree->buildTree();
+	printf("Photon proxy of %s: %d of %d triangles\n", file.c_str(), (int)proxyList.size(), (int)triangleList.size());
 }
\ No newline at end of file
@@ -0,0 +1,359 @@
+#include "mesh_io.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// ------------------- OBJ -------------------
+// The file is scanned once, line by line, with hand-written number parsing.
+// Large files are split at line boundaries into chunks that are parsed in
+// parallel and concatenated in order.
+
+#ifndef OBJ_CHUNK_SIZE
+#define OBJ_CHUNK_SIZE (8 << 20)
+#endif
+
+const char *nextLine(const char *p, const char *end) {
+	const char *q = (const char *)memchr(p, '\n', end - p);
+	return q == NULL ? end : q + 1;
+}
+
+bool parseInt(const char *&p, const char *end, int &out) {
+	skipBlank(p, end);
+	bool neg = false;
+	if (p < end && (*p == '-' || *p == '+')) neg = (*p++ == '-');
+	if (p >= end || *p < '0' || *p > '9') return false;
+	int value = 0;
+	while (p < end && *p >= '0' && *p <= '9')
+		value = value * 10 + (*p++ - '0');
+	out = neg ? -value : value;
+	return true;
+}
+
+bool parseReal(const char *&p, const char *end, Real &out) {
+	static const double pow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+		1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+	skipBlank(p, end);
+	bool neg = false;
+	if (p < end && (*p == '-' || *p == '+')) neg = (*p++ == '-');
+	uint64_t mantissa = 0;
+	int digits = 0, exponent = 0;
+	bool any = false;
+	for (; p < end && *p >= '0' && *p <= '9'; ++p, any = true) {
+		if (digits < 19) mantissa = mantissa * 10 + (*p - '0'), digits += mantissa > 0;
+		else exponent++;
+	}
+	if (p < end && *p == '.') {
+		for (++p; p < end && *p >= '0' && *p <= '9'; ++p, any = true)
+			if (digits < 19) mantissa = mantissa * 10 + (*p - '0'), digits += mantissa > 0, exponent--;
+	}
+	if (!any) return false;
+	if (p < end && (*p == 'e' || *p == 'E')) {
+		const char *q = p + 1;
+		int e;
+		if (parseInt(q, end, e)) exponent += e, p = q;
+	}
+	double value = mantissa;
+	while (exponent > 22) value *= 1e22, exponent -= 22;
+	while (exponent < -22) value /= 1e22, exponent += 22;
+	value = exponent >= 0 ? value * pow10[exponent] : value / pow10[-exponent];
+	out = neg ? -value : value;
+	return true;
+}
+
+std::string parseWord(const char *&p, const char *end) {
+	skipBlank(p, end);
+	const char *s = p;
+	while (p < end && !isBlank(*p) && *p != '\n') ++p;
+	return std::string(s, p);
+}
+
+// What one chunk of an OBJ file contributed. Face material indices point into
+// the chunk's mtlNames; -1 means "whatever was active before this chunk".
+struct ObjChunk {
+	std::vector<Vector3f> v, vn;
+	std::vector<std::pair<Real, Real> > vt;
+	std::vector<MeshFace> faces;
+	std::vector<std::string> mtllibs, mtlNames;
+	int lastMtl = -1;
+};
+
+static void parseObjChunk(const char *p, const char *end, ObjChunk &chunk) {
+	int curMtl = -1;
+	for (const char *line = p; line < end; line = nextLine(line, end)) {
+		const char *q = line;
+		skipBlank(q, end);
+		if (q >= end || *q == '#' || *q == '\n') continue;
+
+		if (isKeyword(q, end, "v", 1)) {
+			q += 1;
+			Vector3f pos;
+			parseReal(q, end, pos[0]), parseReal(q, end, pos[1]), parseReal(q, end, pos[2]);
+			chunk.v.push_back(pos);
+		}
+		else if (isKeyword(q, end, "vt", 2)) {
+			q += 2;
+			std::pair<Real, Real> uv(0, 0);
+			parseReal(q, end, uv.second), parseReal(q, end, uv.first);
+			chunk.vt.push_back(uv);
+		}
+		else if (isKeyword(q, end, "vn", 2)) {
+			q += 2;
+			Vector3f n;
+			parseReal(q, end, n[0]), parseReal(q, end, n[1]), parseReal(q, end, n[2]);
+			chunk.vn.push_back(n);
+		}
+		else if (isKeyword(q, end, "f", 1)) {
+			q += 1;
+			// triangulate as a fan around the first corner
+			MeshFace face;
+			face.mtl = curMtl;
+			int corner = 0;
+			while (true) {
+				int idx[3] = {-1, -1, -1};
+				if (!parseInt(q, end, idx[0])) break;
+				for (int k = 1; k < 3 && q < end && *q == '/'; ++k) {
+					++q;
+					if (q < end && *q != '/' && !isBlank(*q) && *q != '\n')
+						parseInt(q, end, idx[k]);
+				}
+				int j = corner < 3 ? corner : 2;
+				if (corner >= 3) {
+					face.v[1] = face.v[2], face.vt[1] = face.vt[2], face.vn[1] = face.vn[2];
+				}
+				face.v[j] = idx[0], face.vt[j] = idx[1], face.vn[j] = idx[2];
+				if (++corner >= 3)
+					chunk.faces.push_back(face);
+			}
+		}
+		else if (isKeyword(q, end, "usemtl", 6)) {
+			q += 6;
+			chunk.mtlNames.push_back(parseWord(q, end));
+			curMtl = chunk.lastMtl = chunk.mtlNames.size() - 1;
+		}
+		else if (isKeyword(q, end, "mtllib", 6)) {
+			q += 6;
+			chunk.mtllibs.push_back(parseWord(q, end));
+		}
+	}
+}
+
+void parseObj(const char *begin, size_t size, MeshData &mesh) {
+	const char *end = begin + size;
+	int chunkCnt = 1;
+#ifdef _OPENMP
+	if (size >= 2 * (size_t)OBJ_CHUNK_SIZE)
+		chunkCnt = std::max(1, std::min(omp_get_max_threads(), int(size / OBJ_CHUNK_SIZE)));
+#endif
+	std::vector<const char *> bounds(chunkCnt + 1);
+	bounds[0] = begin, bounds[chunkCnt] = end;
+	for (int i = 1; i < chunkCnt; ++i) {
+		const char *p = begin + size / chunkCnt * i;
+		bounds[i] = p <= bounds[i - 1] ? bounds[i - 1] : nextLine(p, end);
+	}
+	std::vector<ObjChunk> chunks(chunkCnt);
+	#pragma omp parallel for schedule(static, 1) if(chunkCnt > 1)
+	for (int i = 0; i < chunkCnt; ++i)
+		parseObjChunk(bounds[i], bounds[i + 1], chunks[i]);
+
+	// concatenate in file order; indices in faces are already global
+	mesh.v.assign(1, Vector3f(0));
+	mesh.vt.assign(1, std::make_pair(Real(0), Real(0)));
+	mesh.vn.assign(1, Vector3f(0));
+	mesh.faces.clear();
+	mesh.mtllibs.clear();
+	mesh.mtlNames.clear();
+	std::map<std::string, int> nameIds;
+	int curMtl = -1;
+	for (int i = 0; i < chunkCnt; ++i) {
+		ObjChunk &chunk = chunks[i];
+		mesh.v.insert(mesh.v.end(), chunk.v.begin(), chunk.v.end());
+		mesh.vt.insert(mesh.vt.end(), chunk.vt.begin(), chunk.vt.end());
+		mesh.vn.insert(mesh.vn.end(), chunk.vn.begin(), chunk.vn.end());
+		mesh.mtllibs.insert(mesh.mtllibs.end(), chunk.mtllibs.begin(), chunk.mtllibs.end());
+
+		std::vector<int> ids(chunk.mtlNames.size());
+		for (size_t k = 0; k < ids.size(); ++k) {
+			std::map<std::string, int>::iterator it = nameIds.find(chunk.mtlNames[k]);
+			if (it == nameIds.end()) {
+				it = nameIds.insert(std::make_pair(chunk.mtlNames[k], (int)mesh.mtlNames.size())).first;
+				mesh.mtlNames.push_back(chunk.mtlNames[k]);
+			}
+			ids[k] = it->second;
+		}
+		for (size_t k = 0; k < chunk.faces.size(); ++k) {
+			MeshFace face = chunk.faces[k];
+			face.mtl = face.mtl == -1 ? curMtl : ids[face.mtl];
+			mesh.faces.push_back(face);
+		}
+		if (chunk.lastMtl != -1)
+			curMtl = ids[chunk.lastMtl];
+	}
+}
+
+// ------------------- Binary mesh -------------------
+
+static size_t alignUp(size_t x) {
+	return (x + 7) & ~(size_t)7;
+}
+
+bool isBinaryMesh(const char *data, size_t size) {
+	return data != NULL && size >= sizeof(BinaryMeshHeader) && memcmp(data, "BMSH", 4) == 0;
+}
+
+bool loadBinaryMesh(const char *data, size_t size, MeshData &mesh) {
+	if (!isBinaryMesh(data, size)) return false;
+	BinaryMeshHeader header;
+	memcpy(&header, data, sizeof(header));
+	if (header.version != BINARY_MESH_VERSION || header.fileSize != size) {
+		printf("Unsupported binary mesh version or truncated file\n");
+		return false;
+	}
+	bool quantized = header.flags & BINARY_MESH_QUANTIZED;
+	size_t vertexBytes = (size_t)header.vertexCnt * 3 * (quantized ? sizeof(uint16_t) : sizeof(float));
+	size_t faceBytes = (size_t)header.faceCnt * 3 * sizeof(int32_t);
+	size_t faceMtlBytes = (size_t)header.faceCnt * sizeof(int32_t);
+	// offsets come from the file, so compare against the room left after
+	// them instead of adding to them, which could wrap
+	if (header.vertexOffset > size || vertexBytes > size - header.vertexOffset
+		|| header.faceOffset > size || faceBytes > size - header.faceOffset
+		|| header.faceMtlOffset > size || faceMtlBytes > size - header.faceMtlOffset
+		|| header.stringOffset > size) {
+		printf("Corrupted binary mesh\n");
+		return false;
+	}
+
+	// vertex and index arrays are decoded from the mapped file into the
+	// MeshData vectors; indices keep their OBJ meaning and are range-checked
+	// when triangles are built. mesh is only replaced once all of it decoded.
+	MeshData out;
+	out.v.resize(header.vertexCnt + 1);
+	out.v[0] = Vector3f(0);
+	if (quantized) {
+		const uint16_t *q = (const uint16_t *)(data + header.vertexOffset);
+		for (uint32_t i = 0; i < header.vertexCnt; ++i)
+			for (int k = 0; k < 3; ++k)
+				out.v[i + 1][k] = header.boxMin[k] + (header.boxMax[k] - header.boxMin[k]) * (q[3 * i + k] / 65535.0);
+	}
+	else {
+		const float *f = (const float *)(data + header.vertexOffset);
+		for (uint32_t i = 0; i < header.vertexCnt; ++i)
+			out.v[i + 1] = Vector3f(f[3 * i], f[3 * i + 1], f[3 * i + 2]);
+	}
+
+	const int32_t *idx = (const int32_t *)(data + header.faceOffset);
+	const int32_t *faceMtl = (const int32_t *)(data + header.faceMtlOffset);
+	out.faces.resize(header.faceCnt);
+	for (uint32_t i = 0; i < header.faceCnt; ++i) {
+		MeshFace &face = out.faces[i];
+		for (int k = 0; k < 3; ++k) {
+			face.v[k] = idx[3 * i + k];
+			face.vt[k] = face.vn[k] = -1;
+		}
+		face.mtl = faceMtl[i];
+		if (face.mtl < -1 || face.mtl >= (int)header.mtlNameCnt) {
+			printf("Corrupted binary mesh\n");
+			return false;
+		}
+	}
+
+	// strings are stored as a 32-bit length followed by the characters
+	const char *p = data + header.stringOffset, *end = data + size;
+	std::vector<std::string> strings;
+	for (uint32_t i = 0; i < header.mtllibCnt + header.mtlNameCnt; ++i) {
+		uint32_t len;
+		if ((size_t)(end - p) < sizeof(len)) {
+			printf("Corrupted binary mesh\n");
+			return false;
+		}
+		memcpy(&len, p, sizeof(len));
+		p += sizeof(len);
+		if ((size_t)(end - p) < len) {
+			printf("Corrupted binary mesh\n");
+			return false;
+		}
+		strings.push_back(std::string(p, len));
+		p += len;
+	}
+	out.mtllibs.assign(strings.begin(), strings.begin() + header.mtllibCnt);
+	out.mtlNames.assign(strings.begin() + header.mtllibCnt, strings.end());
+	out.vt.assign(1, std::make_pair(Real(0), Real(0)));
+	out.vn.assign(1, Vector3f(0));
+	std::swap(mesh, out);
+	return true;
+}
+
+bool saveBinaryMesh(const char *filename, const MeshData &mesh, bool quantize) {
+	BinaryMeshHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, "BMSH", 4);
+	header.version = BINARY_MESH_VERSION;
+	header.flags = quantize ? BINARY_MESH_QUANTIZED : 0;
+	header.vertexCnt = mesh.v.size() - 1;
+	header.faceCnt = mesh.faces.size();
+	header.mtllibCnt = mesh.mtllibs.size();
+	header.mtlNameCnt = mesh.mtlNames.size();
+	for (int k = 0; k < 3; ++k)
+		header.boxMin[k] = 1e30f, header.boxMax[k] = -1e30f;
+	for (size_t i = 1; i < mesh.v.size(); ++i)
+		for (int k = 0; k < 3; ++k) {
+			header.boxMin[k] = std::min(header.boxMin[k], (float)mesh.v[i][k]);
+			header.boxMax[k] = std::max(header.boxMax[k], (float)mesh.v[i][k]);
+		}
+
+	std::vector<char> vertices;
+	if (quantize) {
+		std::vector<uint16_t> q(3 * header.vertexCnt);
+		for (uint32_t i = 0; i < header.vertexCnt; ++i)
+			for (int k = 0; k < 3; ++k) {
+				double extent = header.boxMax[k] - header.boxMin[k];
+				double t = extent > 0 ? (mesh.v[i + 1][k] - header.boxMin[k]) / extent : 0;
+				q[3 * i + k] = (uint16_t)(std::min(1.0, std::max(0.0, t)) * 65535.0 + 0.5);
+			}
+		vertices.assign((const char *)q.data(), (const char *)(q.data() + q.size()));
+	}
+	else {
+		std::vector<float> f(3 * header.vertexCnt);
+		for (uint32_t i = 0; i < header.vertexCnt; ++i)
+			for (int k = 0; k < 3; ++k)
+				f[3 * i + k] = mesh.v[i + 1][k];
+		vertices.assign((const char *)f.data(), (const char *)(f.data() + f.size()));
+	}
+	std::vector<int32_t> idx(3 * header.faceCnt), faceMtl(header.faceCnt);
+	for (uint32_t i = 0; i < header.faceCnt; ++i) {
+		for (int k = 0; k < 3; ++k)
+			idx[3 * i + k] = mesh.faces[i].v[k];
+		faceMtl[i] = mesh.faces[i].mtl;
+	}
+	std::vector<char> strings;
+	for (int pass = 0; pass < 2; ++pass) {
+		const std::vector<std::string> &list = pass == 0 ? mesh.mtllibs : mesh.mtlNames;
+		for (size_t i = 0; i < list.size(); ++i) {
+			uint32_t len = list[i].size();
+			strings.insert(strings.end(), (const char *)&len, (const char *)&len + sizeof(len));
+			strings.insert(strings.end(), list[i].begin(), list[i].end());
+		}
+	}
+
+	header.vertexOffset = alignUp(sizeof(header));
+	header.faceOffset = alignUp(header.vertexOffset + vertices.size());
+	header.faceMtlOffset = alignUp(header.faceOffset + idx.size() * sizeof(int32_t));
+	header.stringOffset = alignUp(header.faceMtlOffset + faceMtl.size() * sizeof(int32_t));
+	header.fileSize = header.stringOffset + strings.size();
+
+	std::vector<char> out(header.fileSize, 0);
+	memcpy(&out[0], &header, sizeof(header));
+	if (!vertices.empty()) memcpy(&out[header.vertexOffset], vertices.data(), vertices.size());
+	if (!idx.empty()) memcpy(&out[header.faceOffset], idx.data(), idx.size() * sizeof(int32_t));
+	if (!faceMtl.empty()) memcpy(&out[header.faceMtlOffset], faceMtl.data(), faceMtl.size() * sizeof(int32_t));
+	if (!strings.empty()) memcpy(&out[header.stringOffset], strings.data(), strings.size());
+
+	FILE *file = fopen(filename, "wb");
+	if (file == NULL) return false;
+	bool ok = fwrite(out.data(), out.size(), 1, file) == 1;
+	fclose(file);
+	return ok;
+}
@@ -0,0 +1,188 @@
+#include "mesh_simplify.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <utility>
+
+// weight of the planes holding border edges, relative to face planes
+#define BORDER_WEIGHT 100
+
+// Symmetric 4x4 matrix of the squared distance to a set of planes, upper
+// triangle row by row.
+struct Quadric {
+	double q[10];
+
+	Quadric() {
+		std::fill(q, q + 10, 0.0);
+	}
+
+	// plane n . x + d = 0 with unit n
+	Quadric(const Vector3f &n, double d, double w) {
+		double a = n.x(), b = n.y(), c = n.z();
+		q[0] = a * a, q[1] = a * b, q[2] = a * c, q[3] = a * d;
+		q[4] = b * b, q[5] = b * c, q[6] = b * d;
+		q[7] = c * c, q[8] = c * d;
+		q[9] = d * d;
+		for (int i = 0; i < 10; ++i)
+			q[i] *= w;
+	}
+
+	Quadric &operator+=(const Quadric &o) {
+		for (int i = 0; i < 10; ++i)
+			q[i] += o.q[i];
+		return *this;
+	}
+
+	double error(const Vector3f &v) const {
+		double x = v.x(), y = v.y(), z = v.z();
+		return q[0] * x * x + 2 * q[1] * x * y + 2 * q[2] * x * z + 2 * q[3] * x
+			+ q[4] * y * y + 2 * q[5] * y * z + 2 * q[6] * y
+			+ q[7] * z * z + 2 * q[8] * z + q[9];
+	}
+};
+
+struct Collapse {
+	double cost;
+	int u, v;
+	int stampU, stampV;
+	Vector3f position;
+
+	bool operator>(const Collapse &o) const {
+		return cost > o.cost;
+	}
+};
+
+static Vector3f faceNormal(const Vector3f &a, const Vector3f &b, const Vector3f &c) {
+	return Vector3f::cross(b - a, c - a);
+}
+
+void simplifyMesh(std::vector<Vector3f> &vertices, std::vector<int> &indices, std::vector<int> &sources, int target) {
+	int vCnt = vertices.size(), fCnt = indices.size() / 3;
+	std::vector<Quadric> quadrics(vCnt);
+	std::vector<std::vector<int> > vertexFaces(vCnt);
+	std::vector<std::pair<std::pair<int, int>, int> > edges;
+	for (int f = 0; f < fCnt; ++f) {
+		const int *idx = &indices[3 * f];
+		Vector3f n = faceNormal(vertices[idx[0]], vertices[idx[1]], vertices[idx[2]]);
+		// weighted by area, so large faces are kept flatter
+		Real area = n.length();
+		if (area > 0) {
+			n = n / area;
+			Quadric plane(n, -Vector3f::dot(n, vertices[idx[0]]), area);
+			for (int j = 0; j < 3; ++j)
+				quadrics[idx[j]] += plane;
+		}
+		for (int j = 0; j < 3; ++j) {
+			vertexFaces[idx[j]].push_back(f);
+			int a = idx[j], b = idx[(j + 1) % 3];
+			if (a != b)
+				edges.push_back(std::make_pair(std::make_pair(std::min(a, b), std::max(a, b)), f));
+		}
+	}
+	std::sort(edges.begin(), edges.end());
+	for (size_t i = 0; i < edges.size(); ++i) {
+		bool border = (i == 0 || edges[i - 1].first != edges[i].first)
+			&& (i + 1 == edges.size() || edges[i + 1].first != edges[i].first);
+		if (!border) continue;
+		const int *idx = &indices[3 * edges[i].second];
+		int a = edges[i].first.first, b = edges[i].first.second;
+		Vector3f e = vertices[b] - vertices[a];
+		Vector3f m = Vector3f::cross(e, faceNormal(vertices[idx[0]], vertices[idx[1]], vertices[idx[2]]));
+		if (m.length() == 0) continue;
+		m.normalize();
+		Quadric plane(m, -Vector3f::dot(m, vertices[a]), BORDER_WEIGHT * e.squaredLength());
+		quadrics[a] += plane;
+		quadrics[b] += plane;
+	}
+
+	std::vector<int> stamp(vCnt, 0);
+	std::vector<char> vertexAlive(vCnt, 1), faceAlive(fCnt, 1);
+	std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse> > heap;
+	auto push = [&](int u, int v) {
+		Quadric q = quadrics[u];
+		q += quadrics[v];
+		Vector3f candidates[3] = {vertices[u], vertices[v], (vertices[u] + vertices[v]) / 2};
+		Collapse c;
+		c.cost = -1;
+		for (int k = 0; k < 3; ++k) {
+			double err = q.error(candidates[k]);
+			if (c.cost < 0 || err < c.cost)
+				c.cost = std::max(err, 0.0), c.position = candidates[k];
+		}
+		c.u = u, c.v = v, c.stampU = stamp[u], c.stampV = stamp[v];
+		heap.push(c);
+	};
+	// whether moving u to p turns over one of its faces that does not also
+	// contain v (those disappear); degenerate faces have no side to keep
+	auto flips = [&](int u, int v, const Vector3f &p) {
+		for (size_t i = 0; i < vertexFaces[u].size(); ++i) {
+			int f = vertexFaces[u][i];
+			const int *idx = &indices[3 * f];
+			if (!faceAlive[f] || idx[0] == v || idx[1] == v || idx[2] == v) continue;
+			Vector3f before = faceNormal(vertices[idx[0]], vertices[idx[1]], vertices[idx[2]]);
+			if (before.length() == 0) continue;
+			Vector3f moved[3];
+			for (int j = 0; j < 3; ++j)
+				moved[j] = idx[j] == u ? p : vertices[idx[j]];
+			if (Vector3f::dot(before, faceNormal(moved[0], moved[1], moved[2])) <= 0) return true;
+		}
+		return false;
+	};
+	for (size_t i = 0; i < edges.size(); ++i)
+		if (i == 0 || edges[i - 1].first != edges[i].first)
+			push(edges[i].first.first, edges[i].first.second);
+
+	int live = fCnt;
+	std::vector<int> neighbours;
+	while (live > target && !heap.empty()) {
+		Collapse c = heap.top();
+		heap.pop();
+		int u = c.u, v = c.v;
+		if (!vertexAlive[u] || !vertexAlive[v] || stamp[u] != c.stampU || stamp[v] != c.stampV) continue;
+		if (flips(u, v, c.position) || flips(v, u, c.position)) continue;
+
+		// merge v into u
+		vertices[u] = c.position;
+		quadrics[u] += quadrics[v];
+		vertexAlive[v] = 0;
+		for (size_t i = 0; i < vertexFaces[v].size(); ++i) {
+			int f = vertexFaces[v][i];
+			if (!faceAlive[f]) continue;
+			int *idx = &indices[3 * f];
+			if (idx[0] == u || idx[1] == u || idx[2] == u) {
+				faceAlive[f] = 0;
+				live--;
+				continue;
+			}
+			for (int j = 0; j < 3; ++j)
+				if (idx[j] == v) idx[j] = u;
+			vertexFaces[u].push_back(f);
+		}
+		vertexFaces[v].clear();
+		std::vector<int> &faces = vertexFaces[u];
+		faces.erase(std::remove_if(faces.begin(), faces.end(), [&](int f) { return !faceAlive[f]; }), faces.end());
+
+		// every edge at u changed cost
+		stamp[u]++;
+		neighbours.clear();
+		for (size_t i = 0; i < faces.size(); ++i)
+			for (int j = 0; j < 3; ++j)
+				if (indices[3 * faces[i] + j] != u)
+					neighbours.push_back(indices[3 * faces[i] + j]);
+		std::sort(neighbours.begin(), neighbours.end());
+		neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+		for (size_t i = 0; i < neighbours.size(); ++i)
+			push(u, neighbours[i]);
+	}
+
+	std::vector<int> kept;
+	sources.clear();
+	for (int f = 0; f < fCnt; ++f) {
+		if (!faceAlive[f]) continue;
+		sources.push_back(f);
+		for (int j = 0; j < 3; ++j)
+			kept.push_back(indices[3 * f + j]);
+	}
+	indices.swap(kept);
+}
@@ -0,0 +1,32 @@
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include "mapped_file.hpp"
+#include "mesh_io.hpp"
+
+using namespace std;
+
+// Convert a text OBJ into a binary mesh that TriangleMesh can map without
+// parsing. Vertices are stored as floats, or as 16-bit integers over the
+// bounding box with --quantize.
+int main(int argc, char *argv[]) {
+    bool quantize = argc == 4 && !strcmp(argv[3], "--quantize");
+    if (argc != 3 && !quantize) {
+        cout << "Usage: ./bin/meshconv <input obj file> <output bmesh file> [--quantize]" << endl;
+        return 1;
+    }
+    MappedFile mapped(argv[1]);
+    if (mapped.data() == NULL) {
+        cout << "cannot open input mesh" << endl;
+        return 1;
+    }
+    MeshData mesh;
+    parseObj(mapped.data(), mapped.size(), mesh);
+    if (!saveBinaryMesh(argv[2], mesh, quantize)) {
+        cout << "cannot write output mesh" << endl;
+        return 1;
+    }
+    printf("vCnt: %d, fCnt: %d, materials: %d\n", (int)mesh.v.size() - 1, (int)mesh.faces.size(), (int)mesh.mtlNames.size());
+    return 0;
+}
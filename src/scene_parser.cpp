@@ -18,6 +18,7 @@ SceneParser::SceneParser(const char *filename) {
     num_materials = 0;
     materials = nullptr;
     current_material = nullptr;
+    transformDepth = 0;
 
     // parse the file
     assert(filename != nullptr);
@@ -79,6 +80,8 @@ void SceneParser::parseFile() {
             parseMaterials();
         } else if (!strcmp(token, "Group")) {
             group = parseGroup();
+        } else if (!strcmp(token, "Render")) {
+            parseRender();
         } else {
             printf("Unknown token in parseFile: '%s'\n", token);
             exit(0);
@@ -153,6 +156,24 @@ void SceneParser::parseBackground() {
     }
 }
 
+void SceneParser::parseRender() {
+    char token[MAX_PARSER_TOKEN_LENGTH];
+    char value[MAX_PARSER_TOKEN_LENGTH];
+    // renderer parameters as key value pairs
+    getToken(token);
+    assert (!strcmp(token, "{"));
+    while (true) {
+        getToken(token);
+        if (!strcmp(token, "}"))
+            break;
+        getToken(value);
+        if (!settings.set(token, value)) {
+            printf("Unknown token in parseRender: '%s %s'\n", token, value);
+            exit(0);
+        }
+    }
+}
+
 // ====================================================================
 // ====================================================================
 
@@ -296,6 +317,10 @@ void SceneParser::parseMaterials() {
     }
     getToken(token);
     assert (!strcmp(token, "}"));
+    // textures are independent, read them in parallel
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int i = 0; i < num_materials; ++i)
+        materials[i]->loadTexture();
 }
 
 
@@ -484,8 +509,9 @@ Mesh *SceneParser::parseTriangleMesh() {
     getToken(filename);
     getToken(token);
     assert (!strcmp(token, "}"));
-    const char *ext = &filename[strlen(filename) - 4];
-    assert(!strcmp(ext, ".obj"));
+    // text OBJ or binary mesh written by meshconv
+    const char *ext = strrchr(filename, '.');
+    assert(ext != NULL && (!strcmp(ext, ".obj") || !strcmp(ext, ".bmesh")));
     //std::cout << filename << std::endl;
     Mesh *answer = new Mesh(filename, current_material, scale);
     printf("Scale: [%lf]\n",scale);
@@ -497,6 +523,10 @@ Transform *SceneParser::parseTransform() {
     char token[MAX_PARSER_TOKEN_LENGTH];
     Matrix4f matrix = Matrix4f::identity();
     Object3D *object = nullptr;
+    if (++transformDepth > MAX_INSTANCE_DEPTH) {
+        printf("Transforms nested deeper than %d\n", MAX_INSTANCE_DEPTH);
+        exit(0);
+    }
     getToken(token);
     assert (!strcmp(token, "{"));
     // read in transformations: 
@@ -553,6 +583,7 @@ Transform *SceneParser::parseTransform() {
     assert(object != nullptr);
     getToken(token);
     assert (!strcmp(token, "}"));
+    transformDepth--;
     return new Transform(matrix, object);
 }
 
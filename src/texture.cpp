@@ -0,0 +1,87 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "texture.hpp"
+#include "image.hpp"
+#include "mapped_file.hpp"
+
+// Textures at least this large are tiled by several threads.
+#define TEXTURE_PARALLEL_TEXELS (1 << 20)
+
+Texture::Texture(int w, int h, const unsigned char *rows, long stride, bool bgr) {
+    levels.resize(1);
+    MipLevel &base = levels[0];
+    base.init(w, h);
+    // copy a tile row (TEXTURE_TILE texels) at a time
+    #pragma omp parallel for schedule(static) if((size_t)w * h >= TEXTURE_PARALLEL_TEXELS)
+    for (int y = 0; y < h; ++y) {
+        const unsigned char *src = rows + y * stride;
+        for (int x = 0; x < w; x += TEXTURE_TILE) {
+            int len = std::min(TEXTURE_TILE, w - x);
+            unsigned char *dst = &base.texels[3 * base.offset(x, y)];
+            if (!bgr)
+                memcpy(dst, src + 3 * x, 3 * len);
+            else
+                for (int i = 0; i < len; ++i) {
+                    dst[3 * i] = src[3 * (x + i) + 2];
+                    dst[3 * i + 1] = src[3 * (x + i) + 1];
+                    dst[3 * i + 2] = src[3 * (x + i)];
+                }
+        }
+    }
+    buildMipmaps();
+}
+
+// Each level averages 2x2 texels of the previous one, down to 1x1. Odd sizes
+// are rounded down and the last row or column is folded into its neighbour.
+void Texture::buildMipmaps() {
+    while (levels.back().width > 1 || levels.back().height > 1) {
+        levels.push_back(MipLevel());
+        const MipLevel &src = levels[levels.size() - 2];
+        MipLevel &dst = levels.back();
+        dst.init(std::max(1, src.width / 2), std::max(1, src.height / 2));
+        for (int y = 0; y < dst.height; ++y)
+            for (int x = 0; x < dst.width; ++x) {
+                int sum[3] = {0, 0, 0}, cnt = 0;
+                int x1 = x == dst.width - 1 ? src.width : std::min(src.width, 2 * x + 2);
+                int y1 = y == dst.height - 1 ? src.height : std::min(src.height, 2 * y + 2);
+                for (int sy = 2 * y; sy < y1; ++sy)
+                    for (int sx = 2 * x; sx < x1; ++sx, ++cnt)
+                        for (int c = 0; c < 3; ++c)
+                            sum[c] += src.texels[3 * src.offset(sx, sy) + c];
+                unsigned char *p = &dst.texels[3 * dst.offset(x, y)];
+                for (int c = 0; c < 3; ++c)
+                    p[c] = (sum[c] + cnt / 2) / cnt;
+            }
+    }
+}
+
+size_t Texture::Bytes() const {
+    size_t bytes = 0;
+    for (size_t i = 0; i < levels.size(); ++i)
+        bytes += levels[i].texels.size();
+    return bytes;
+}
+
+// The file is mapped and its rows copied straight into the tiles, bottom
+// row first so that (0,0) is the bottom left corner.
+Texture *Texture::Load(const char *filename) {
+    assert(filename != NULL);
+    const char *ext = strrchr(filename, '.');
+    bool tga = ext != NULL && !strcmp(ext, ".tga");
+    assert(tga || (ext != NULL && !strcmp(ext, ".ppm")));
+    MappedFile file(filename);
+    int width = 0;
+    int height = 0;
+    const unsigned char *pixels = tga ? ReadTGAHeader(file.data(), file.size(), width, height)
+                                      : ReadPPMHeader(file.data(), file.size(), width, height);
+    if (pixels == NULL) {
+        printf("Cannot read texture %s\n", filename);
+        return NULL;
+    }
+    long stride = 3L * width;
+    Texture *answer = new Texture(width, height, pixels + (height - 1) * stride, -stride, tga);
+    printf("Texture %s: %dx%d, %d levels, %.1lf MB\n", filename, width, height, answer->NumLevels(), answer->Bytes() / 1048576.0);
+    return answer;
+}